@@ -8,7 +8,7 @@ workspace "HackAssembler"
    -- Workspace-wide build options for MSVC
    filter "system:windows"
       flags { "MultiProcessorCompile" }
-      buildoptions { "/EHsc", "/Zc:preprocessor", "/Zc:__cplusplus" }
+      buildoptions { "/EHsc", "/Zc:preprocessor", "/Zc:__cplusplus", "/constexpr:steps10000000" }
 
 OutputDir = "%{cfg.system}-%{cfg.architecture}/%{cfg.buildcfg}"
 
@@ -1,9 +1,164 @@
-#include "Assembler/Parser.h"
-#include "Assembler/CodeGeneration.h"
+#include "Assembler/Assemble.h"
+#include "Assembler/OutputFormat.h"
+#include "Assembler/Pipeline.h"
+#include "Assembler/WorkStealingPool.h"
+#include "Assembler/Trace.h"
 
 #include "IO/Log.h"
 #include "IO/File.h"
 #include "IO/CLI.h"
+#include "IO/Memory.h"
+
+#include <mutex>
+#include <sstream>
+#include <memory_resource>
+#include <unordered_set>
+
+// Per batch worker, reused by the arena of every job it runs
+static constexpr size_t BatchArenaSize = 1 << 20;
+
+static Assembler::Options GetAssemblerOptions(const CLI::Options& options, std::string sourceName, size_t jobs) {
+    return {
+        .SourceName = std::move(sourceName),
+        .DiagnosticsFormat = options.DiagnosticsFormat,
+        .MaxErrors = options.MaxErrors,
+        .Jobs = jobs,
+    };
+}
+
+static double PerSecond(double count, Statistics::Clock::duration elapsed) {
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0 ? count / seconds : 0;
+}
+
+static void PrintStatistics(std::ostream& out, const Statistics& statistics) {
+    Log::Message(out, "{:<14} {:>10} {:>12}", "phase", "ms", "input MB/s");
+    for (const Statistics::Phase& phase : statistics.Phases) {
+        Log::Message(out, "{:<14} {:>10.3f} {:>12.1f}", phase.Name, std::chrono::duration<double, std::milli>(phase.Elapsed).count(), PerSecond(statistics.Bytes / 1e6, phase.Elapsed));
+    }
+
+    const Statistics::Clock::duration total = statistics.Total();
+    Log::Message(out, "{:<14} {:>10.3f} {:>12.1f}", "total", std::chrono::duration<double, std::milli>(total).count(), PerSecond(statistics.Bytes / 1e6, total));
+
+    Log::Message(out, "input: {} bytes, {} lines, {} tokens, {} instructions, {} of them matched without tokens, {} parse chunks",
+        statistics.Bytes, statistics.Lines, statistics.Tokens, statistics.Instructions, statistics.CanonicalInstructions, statistics.Chunks);
+    Log::Message(out, "throughput: {:.2f}M lines/s, {:.2f}M tokens/s, {:.2f}M instructions/s",
+        PerSecond(statistics.Lines / 1e6, total), PerSecond(statistics.Tokens / 1e6, total), PerSecond(statistics.Instructions / 1e6, total));
+    Log::Message(out, "symbols: {} in {} slots, load factor {:.2f}", statistics.Symbols, statistics.SymbolSlots,
+        statistics.SymbolSlots != 0 ? static_cast<double>(statistics.Symbols) / statistics.SymbolSlots : 0.0);
+
+    if (auto peak = IO::GetPeakResidentSize()) {
+        Log::Message(out, "peak resident memory: {:.1f} MiB", peak.value() / (1024.0 * 1024.0));
+    }
+}
+
+// Assembles one input to one output. Messages and diagnostics go to console only, so that batch jobs running in parallel never interleave.
+// Statistics, if given, get every phase: opening the files, those of the library, and writing the output
+static bool AssembleFile(const CLI::Options& options, const std::string& inputFile, const std::string& outputFile, size_t jobs, std::ostream& console, Statistics* statistics = nullptr) {
+    const bool fromStandardInput = inputFile == CLI::StandardStream;
+    const bool toStandardOutput = outputFile == CLI::StandardStream;
+
+    PhaseTimer openTimer(statistics, "open");
+    Trace::Zone openZone("open", inputFile);
+    auto input = fromStandardInput ? IO::TryOpenStandardInput() : IO::TryOpenFileInput(inputFile);
+    if (!input.has_value()) {
+        Log::Message(console, "Could not open {} for reading", fromStandardInput ? "standard input" : IO::GetAblsolutePath(inputFile));
+        return false;
+    }
+
+    // The pipeline seeks back to patch its output, otherwise the size of the output is known before it is written
+    std::optional<std::ofstream> output;
+    std::optional<IO::MappedOutput> mappedOutput;
+    if (!toStandardOutput) {
+        if (options.Pipeline) {
+            output = IO::TryOpenFileOutput(outputFile, std::ios::out | std::ios::binary);
+        }
+        else {
+            mappedOutput = IO::TryOpenMappedOutput(outputFile);
+        }
+
+        if (!output.has_value() && !mappedOutput.has_value()) {
+            Log::Message(console, "Could not open {} for writing", IO::GetAblsolutePath(outputFile));
+            return false;
+        }
+    }
+
+    openTimer.Stop();
+    openZone.End();
+
+    const std::string sourceName = fromStandardInput ? "<stdin>" : inputFile;
+    if (options.Pipeline) {
+        IO::Diagnostics diagnostics(sourceName, options.DiagnosticsFormat, options.MaxErrors);
+        auto result = Pipeline::Assemble(input.value().View(), diagnostics, output.value());
+        
+        diagnostics.Flush(console);
+        if (!result.Success) {
+            // Output has already been written, leave an empty file like a failed sequential run
+            output.value().close();
+            output.value().open(outputFile);
+            return false;
+        }
+
+        for (const auto& queue : result.Queues) {
+            Log::Message(console, "{}: {} batches, average occupancy {:.2f}/{}, producer waited {} times, consumer waited {} times",
+                queue.Name, queue.Batches, queue.AverageOccupancy, queue.Capacity, queue.FullWaits, queue.EmptyWaits);
+        }
+
+        Log::Message(console, "{} -> {}", IO::GetAblsolutePath(inputFile), IO::GetAblsolutePath(outputFile));
+        return true;
+    }
+
+    Assembler::Options assemblerOptions = GetAssemblerOptions(options, sourceName, jobs);
+    assemblerOptions.Stats = statistics;
+
+    auto code = Assembler::Assemble(input.value().View(), assemblerOptions);
+    if (!code.has_value()) {
+        console << code.error().Diagnostics << std::flush;
+        return false;
+    }
+
+    PhaseTimer writeTimer(statistics, "write");
+    Trace::Zone writeZone("write", outputFile);
+    if (toStandardOutput) {
+        IO::SetStandardOutputBinary();
+        const std::string output = OutputFormat::Write(code.value(), options.Format);
+        std::cout.write(output.data(), static_cast<std::streamsize>(output.size())).flush();
+        return std::cout.good();
+    }
+
+    const size_t size = OutputFormat::GetSize(code.value(), options.Format);
+    std::span<char> mapping = mappedOutput.value().Map(size);
+    bool written = true;
+    if (mapping.size() == size) {
+        OutputFormat::Write(code.value(), options.Format, mapping.data(), jobs);
+    }
+    else {
+        written = mappedOutput.value().Write(OutputFormat::Write(code.value(), options.Format));
+    }
+
+    if (!mappedOutput.value().Close() || !written) {
+        Log::Message(console, "Could not write {}", IO::GetAblsolutePath(outputFile));
+        return false;
+    }
+
+    Log::Message(console, "{} -> {}", IO::GetAblsolutePath(inputFile), IO::GetAblsolutePath(outputFile));
+    return true;
+}
+
+// Once every thread that traced is done
+static bool WriteTrace(const std::string& traceFile) {
+    if (traceFile.empty()) {
+        return true;
+    }
+
+    std::ofstream file(traceFile, std::ios::out | std::ios::binary);
+    if (!file.good() || !Trace::Write(file)) {
+        Log::Message(std::cerr, "Could not write {}", IO::GetAblsolutePath(traceFile));
+        return false;
+    }
+
+    return true;
+}
 
 int main(int argc, char** argv) {
     auto options = CLI::ParseArguments({ argv, static_cast<size_t>(argc) });
@@ -13,32 +168,90 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    Log::SetInputStreamName(options.value().InputFile);
-    auto input = IO::TryOpenFileInput(options.value().InputFile);
-    if (!input.has_value()) {
-        Log::Message("Could not open {} for reading", IO::GetAblsolutePath(options.value().InputFile));
-        return 1;
+    if (!options.value().TraceFile.empty()) {
+        Trace::Enable();
     }
 
-    auto output = IO::TryOpenFileOutput(options.value().OutputFile);
-    if (!output.has_value()) {
-        Log::Message("Could not open {} for writing", IO::GetAblsolutePath(options.value().OutputFile));
+    if (!options.value().Batch) {
+        std::optional<Statistics> statistics;
+        if (options.value().Stats) {
+            statistics.emplace();
+        }
+
+        // Messages must not end up in the output when it is written to standard output
+        std::ostream& console = options.value().OutputFile == CLI::StandardStream ? std::cerr : std::cout;
+        const bool success = AssembleFile(options.value(), options.value().InputFile, options.value().OutputFile, options.value().Jobs, console, statistics ? &statistics.value() : nullptr);
+        if (statistics.has_value()) {
+            PrintStatistics(std::cerr, statistics.value());
+        }
+
+        return WriteTrace(options.value().TraceFile) && success ? 0 : 1;
+    }
+
+    auto inputs = CLI::ExpandBatchInputs(options.value().BatchInputs);
+    if (!inputs.has_value()) {
+        Log::Message("assembler: {}", inputs.error().Message);
         return 1;
     }
 
-    auto code = input.and_then([](auto&& s) { return Parser::Parse(s); })
-        .transform([](auto&& p) { return Parser::ParseResult::ResolveSymbols(p); })
-        .transform(CodeGeneration::GenerateCode);
+    // Every file is one job, parsed on a single thread. The messages of a job are printed together once it is done,
+    // but for its "input -> output" line, which waits until every write is known to have succeeded
+    std::mutex consoleMutex;
+    bool failed = false;
+    std::vector<std::string> written(inputs.value().size());
 
-    if (!code.has_value()) {
-        return 1;
+    IO::FileQueue files(inputs.value(), options.value().IoBackend);
+    WorkStealingPool pool(options.value().Jobs);
+    for (size_t i = 0; i < inputs.value().size(); i++) {
+        pool.Submit([&] {
+            // Jobs take the inputs in order, the order they are read ahead in
+            IO::FileQueue::Input input = files.TakeNext().value();
+            Trace::Zone zone("assemble file", input.Path);
+            const std::string outputFile = CLI::GetDefaultOutputFile(input.Path, options.value().Format);
+
+            std::ostringstream console;
+            bool success = false;
+            if (!input.File.has_value()) {
+                Log::Message(console, "Could not open {} for reading", IO::GetAblsolutePath(input.Path));
+            }
+            else {
+                thread_local std::vector<std::byte> arenaBuffer(BatchArenaSize);
+                std::pmr::monotonic_buffer_resource arena(arenaBuffer.data(), arenaBuffer.size());
+
+                Assembler::Options assemblerOptions = GetAssemblerOptions(options.value(), input.Path, 1);
+                assemblerOptions.Resource = &arena;
+                auto code = Assembler::Assemble(input.File.value().View(), assemblerOptions);
+                if (!code.has_value()) {
+                    console << code.error().Diagnostics;
+                }
+
+                // A failed job leaves an empty output, like a failed single file
+                files.Write(outputFile, code.has_value() ? OutputFormat::Write(code.value(), options.value().Format) : std::string());
+                if (code.has_value()) {
+                    written[input.Index] = outputFile;
+                    success = true;
+                }
+            }
+
+            std::lock_guard lock(consoleMutex);
+            std::cout << console.view() << std::flush;
+            failed |= !success;
+        });
+    }
+
+    pool.Wait();
+    const std::vector<std::string> failedWrites = files.Flush();
+    const std::unordered_set<std::string_view> failedOutputs(failedWrites.begin(), failedWrites.end());
+    for (size_t i = 0; i < written.size(); i++) {
+        if (!written[i].empty() && !failedOutputs.contains(written[i])) {
+            Log::Message("{} -> {}", IO::GetAblsolutePath(inputs.value()[i]), IO::GetAblsolutePath(written[i]));
+        }
     }
 
-    Log::SetOutput(std::move(output.value()));
-    for (uint16_t c : code.value()) {
-        Log::Message("{:0>16b}", c);
+    for (const std::string& path : failedWrites) {
+        Log::Message("Could not write {}", IO::GetAblsolutePath(path));
+        failed = true;
     }
 
-    Log::ResetOutput();
-    Log::Message("{} -> {}", IO::GetAblsolutePath(options.value().InputFile), IO::GetAblsolutePath(options.value().OutputFile));
+    return WriteTrace(options.value().TraceFile) && !failed ? 0 : 1;
 }
\ No newline at end of file
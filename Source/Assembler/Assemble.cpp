@@ -0,0 +1,31 @@
+#include "Assemble.h"
+#include "Parser.h"
+#include "CodeGeneration.h"
+
+#include <sstream>
+#include <array>
+#include <cstddef>
+
+// Enough for the symbol map and code of a small program, larger ones continue on the heap
+static constexpr size_t StackArenaSize = 16 * 1024;
+
+std::expected<std::vector<uint16_t>, Assembler::Failure> Assembler::Assemble(std::string_view source, const Options& options) {
+    std::array<std::byte, StackArenaSize> buffer;
+    std::optional<std::pmr::monotonic_buffer_resource> arena;
+    std::pmr::memory_resource* resource = options.Resource;
+    if (!resource) {
+        resource = &arena.emplace(buffer.data(), buffer.size());
+    }
+
+    IO::Diagnostics diagnostics(options.SourceName, options.DiagnosticsFormat, options.MaxErrors);
+
+    auto parsed = Parser::Parse(source, diagnostics, options.Jobs, resource, options.Stats);
+    if (!parsed.has_value()) {
+        std::ostringstream messages;
+        diagnostics.Flush(messages);
+        return std::unexpected<Failure>(std::in_place, diagnostics.ErrorCount(), std::move(messages).str());
+    }
+
+    PhaseTimer timer(options.Stats, "generate code");
+    return CodeGeneration::GenerateCode(parsed.value());
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Statistics.h"
+
+#include "IO/Diagnostics.h"
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <expected>
+#include <memory_resource>
+#include <limits>
+#include <cstdint>
+
+// The library entry point: assembles a source held in memory. Nothing is read or written but the arguments and the result,
+// and no state is shared between calls, so any number of threads may assemble at once
+namespace Assembler {
+    struct Options {
+        // Names the source in diagnostics
+        std::string SourceName = "<source>";
+        IO::Diagnostics::Format DiagnosticsFormat = IO::Diagnostics::Format::Text;
+        size_t MaxErrors = std::numeric_limits<size_t>::max();
+        // Threads to parse large sources with, 0 for one per core. Sources below the chunk size are always parsed on the calling thread
+        size_t Jobs = 1;
+        // Everything allocated while assembling, but the result, comes from here. I.e. a monotonic_buffer_resource over a buffer
+        // reused for every call. Without one, every call allocates from an arena of its own, seeded by a buffer on the stack
+        std::pmr::memory_resource* Resource = nullptr;
+        // Gets the phases and counters of the call if set, see Statistics
+        Statistics* Stats = nullptr;
+    };
+
+    struct Failure {
+        size_t ErrorCount;
+        // Formatted like the command line prints them
+        std::string Diagnostics;
+    };
+
+    std::expected<std::vector<uint16_t>, Failure> Assemble(std::string_view source, const Options& options = {});
+}
\ No newline at end of file
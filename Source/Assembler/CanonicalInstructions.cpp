@@ -0,0 +1,197 @@
+#include "CanonicalInstructions.h"
+
+#include "Scan.h"
+#include "Language.h"
+
+#include <array>
+#include <algorithm>
+
+// Keys are instruction texts without whitespace, packed five bits per character. 
+// The alphabet is small enough that the longest instruction, "AMD=D|M;JGT", fits in 60 bits
+static constexpr std::string_view Alphabet = "ADM01=;+-!&|JGTEQLNP";
+static constexpr size_t MaxKeyLength = 12;
+
+static constexpr std::array<uint8_t, 256> CharacterCodes = [] {
+    std::array<uint8_t, 256> result{};
+
+    for (size_t i = 0; i < Alphabet.size(); i++) {
+        result[static_cast<uint8_t>(Alphabet[i])] = static_cast<uint8_t>(i + 1);
+    }
+
+    return result;
+}();
+
+static constexpr uint64_t Append(uint64_t key, std::string_view text) {
+    for (char character : text) {
+        key = key << 5 | CharacterCodes[static_cast<uint8_t>(character)];
+    }
+
+    return key;
+}
+
+using Language::Destinations;
+using Language::Comparisons;
+using Language::Jumps;
+
+struct Entry {
+    uint64_t Key = 0;
+    uint16_t Code = 0;
+};
+
+static constexpr size_t EntryCount = [] {
+    size_t result = 0;
+    for (const auto& destination : Destinations) {
+        for (const auto& comparison : Comparisons) {
+            for (const auto& jump : Jumps) {
+                result += Language::IsAccepted(destination, comparison, jump);
+            }
+        }
+    }
+
+    return result;
+}();
+
+static constexpr std::array<Entry, EntryCount> Entries = [] {
+    std::array<Entry, EntryCount> result{};
+
+    size_t count = 0;
+    for (const auto& destination : Destinations) {
+        for (const auto& comparison : Comparisons) {
+            for (const auto& jump : Jumps) {
+                if (!Language::IsAccepted(destination, comparison, jump)) {
+                    continue;
+                }
+
+                uint64_t key = Append(0, destination.Text);
+                key = destination.Text.empty() ? key : Append(key, "=");
+                key = Append(key, comparison.Text);
+                key = jump.Text.empty() ? key : Append(Append(key, ";"), jump.Text);
+
+                result[count++] = Entry{ key, Language::Encode(destination, comparison, jump) };
+            }
+        }
+    }
+
+    return result;
+}();
+
+// Hash and displace: keys are split into buckets, and every bucket gets the displacement that places all of its keys into free slots
+static constexpr size_t BucketBits = 10;
+static constexpr size_t SlotBits = 13;
+
+static constexpr size_t Bucket(uint64_t key) {
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15) >> (64 - BucketBits));
+}
+
+static constexpr size_t Slot(uint64_t key, uint16_t displacement) {
+    return static_cast<size_t>(((key ^ (displacement * 0xC2B2AE3D27D4EB4F)) * 0xD6E8FEB86659FD93) >> (64 - SlotBits));
+}
+
+struct PerfectHash {
+    std::array<uint16_t, 1 << BucketBits> Displacements{};
+    std::array<Entry, 1 << SlotBits> Slots{};
+    bool Valid = true;
+};
+
+static constexpr PerfectHash Table = [] {
+    PerfectHash result;
+
+    // Entries ordered by bucket
+    std::array<size_t, (1 << BucketBits) + 1> offsets{};
+    for (const auto& entry : Entries) {
+        offsets[Bucket(entry.Key) + 1]++;
+    }
+    for (size_t i = 1; i < offsets.size(); i++) {
+        offsets[i] += offsets[i - 1];
+    }
+
+    std::array<size_t, EntryCount> ordered{};
+    std::array<size_t, 1 << BucketBits> filled{};
+    for (size_t i = 0; i < Entries.size(); i++) {
+        size_t bucket = Bucket(Entries[i].Key);
+        ordered[offsets[bucket] + filled[bucket]++] = i;
+    }
+
+    std::array<bool, 1 << SlotBits> used{};
+    size_t largest = 0;
+    for (size_t bucket = 0; bucket < filled.size(); bucket++) {
+        largest = std::max(largest, filled[bucket]);
+    }
+
+    // Largest buckets first, while the table is still mostly empty
+    for (size_t size = largest; size > 0; size--) {
+        for (size_t bucket = 0; bucket < filled.size(); bucket++) {
+            if (filled[bucket] != size) {
+                continue;
+            }
+
+            uint16_t displacement = 0;
+            for (;; displacement++) {
+                bool fits = true;
+                for (size_t i = offsets[bucket]; fits && i < offsets[bucket + 1]; i++) {
+                    size_t slot = Slot(Entries[ordered[i]].Key, displacement);
+                    fits = !used[slot];
+
+                    for (size_t j = offsets[bucket]; fits && j < i; j++) {
+                        fits = Slot(Entries[ordered[j]].Key, displacement) != slot;
+                    }
+                }
+
+                if (fits || displacement == UINT16_MAX) {
+                    result.Valid &= fits;
+                    break;
+                }
+            }
+
+            result.Displacements[bucket] = displacement;
+            for (size_t i = offsets[bucket]; i < offsets[bucket + 1]; i++) {
+                size_t slot = Slot(Entries[ordered[i]].Key, displacement);
+                used[slot] = true;
+                result.Slots[slot] = Entries[ordered[i]];
+            }
+        }
+    }
+
+    return result;
+}();
+
+static_assert(Table.Valid, "No displacement places the bucket without collisions");
+
+std::optional<CanonicalInstructions::Match> CanonicalInstructions::TryMatch(std::string_view stream) {
+    uint64_t key = 0;
+    size_t length = 0;
+    size_t end = 0;
+    bool afterWhitespace = false;
+    bool afterOperation = true;
+
+    for (size_t i = 0; i < stream.size() && stream[i] != '\n'; i++) {
+        char character = stream[i];
+
+        if (Scan::IsWhitespace(character)) {
+            afterWhitespace = true;
+            continue;
+        }
+
+        if (character == '/' && i + 1 < stream.size() && stream[i + 1] == '/') {
+            break;
+        }
+
+        uint8_t code = CharacterCodes[static_cast<uint8_t>(character)];
+        bool operation = Scan::IsOperation(character);
+        if (code == 0 || ++length > MaxKeyLength || (afterWhitespace && !afterOperation && !operation)) {
+            return std::nullopt;
+        }
+
+        key = key << 5 | code;
+        end = i + 1;
+        afterWhitespace = false;
+        afterOperation = operation;
+    }
+
+    if (length == 0) {
+        return std::nullopt;
+    }
+
+    const Entry& entry = Table.Slots[Slot(key, Table.Displacements[Bucket(key)])];
+    return entry.Key == key ? std::optional<Match>(Match{ entry.Code, end }) : std::optional<Match>{};
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string_view>
+#include <optional>
+#include <cstdint>
+
+// Fast path for compute instructions written in one of their canonical spellings (i.e. "D=M", "AM=M-1", "0;JMP").
+// Every legal combination of destination, comparison and jump is encoded at compile time into a perfect hash table.
+namespace CanonicalInstructions {
+    struct Match {
+        uint16_t Code;
+        size_t Length;
+    };
+
+    // Matches the rest of the line, up to a comment, as one compute instruction. Whitespace may only appear
+    // next to operators, where removing it does not change how the instruction is tokenized.
+    // Anything else is left to the parser.
+    std::optional<Match> TryMatch(std::string_view stream);
+}
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "CodeGeneration.h"
+#include "Trace.h"
 
 #include <bitset>
+#include <thread>
+#include <algorithm>
 
 static constexpr uint16_t ToCode(Jumps jump) {
     return static_cast<uint16_t>(jump);
@@ -70,22 +73,42 @@ static constexpr uint16_t ToCode(Comparison comparison) {
     return static_cast<uint16_t>(result.to_ulong());
 }
 
-static constexpr uint16_t Code(const ComputeInstruction& instruction){
+uint16_t CodeGeneration::Encode(const ComputeInstruction& instruction){
     //Identifier: 3bits  Comparison: 7 bits                    Destination: 3 bits                   Jump: 3 bits 
     return 0b111 << 13 | ToCode(instruction.Comparison) << 6 | ToCode(instruction.Destination) << 3 | ToCode(instruction.Jump) << 0;
 }
 
-static constexpr uint16_t Code(const LoadInstruction& instruction) {
-    return instruction.value;
+std::vector<uint16_t> CodeGeneration::GenerateCode(Parser::ParseResult& parsed) {
+    Trace::Zone zone("generate code");
+    return std::move(parsed.Instructions).Link(parsed.Symbols);
 }
 
-std::vector<uint16_t> CodeGeneration::GenerateCode(const std::vector<std::variant<LoadInstruction, ComputeInstruction>>& instructions) {
-    std::vector<uint16_t> result;
-    result.reserve(instructions.size());
+std::string CodeGeneration::FormatText(std::span<const uint16_t> code) {
+    std::string text(code.size() * HackText::LineWidth, '\0');
+    HackText::Encode(code, text.data());
+    return text;
+}
 
-    for (size_t i = 0; i < instructions.size(); i++) {
-        result.emplace_back(std::visit([](const auto& v) { return Code(v); }, instructions[i]));
+// Below this many words per thread, starting threads costs more than it saves
+static constexpr size_t MinimumFormatRange = 1 << 16;
+
+void CodeGeneration::FormatText(std::span<const uint16_t> code, char* out, size_t jobs) {
+    jobs = jobs != 0 ? jobs : std::max(std::thread::hardware_concurrency(), 1u);
+    jobs = std::max<size_t>(std::min(jobs, code.size() / MinimumFormatRange), 1);
+
+    // Ranges are disjoint in both the code and the output, every line has the same width
+    std::vector<std::jthread> workers;
+    const size_t range = code.size() / jobs;
+    for (size_t i = 1; i < jobs; i++) {
+        const size_t start = i * range;
+        const size_t end = i + 1 == jobs ? code.size() : start + range;
+        workers.emplace_back([=] {
+            Trace::Zone zone("format text");
+            HackText::Encode(code.subspan(start, end - start), out + start * HackText::LineWidth);
+        });
     }
 
-    return result;
+    Trace::Zone zone("format text");
+    HackText::Encode(code.first(jobs == 1 ? code.size() : range), out);
+    zone.End();
 }
\ No newline at end of file
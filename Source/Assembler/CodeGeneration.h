@@ -1,9 +1,20 @@
 #pragma once
 
 #include "Parser.h"
+#include "HackText.h"
 
 #include <vector>
+#include <span>
+#include <string>
+#include <string_view>
 
 namespace CodeGeneration {
-    std::vector<uint16_t> GenerateCode(const std::vector<std::variant<LoadInstruction, ComputeInstruction>>& instructions);
+    uint16_t Encode(const ComputeInstruction& instruction);
+
+    // Patches the loads of symbols that were not defined when they were parsed. Variables get their addresses in order of first use
+    std::vector<uint16_t> GenerateCode(Parser::ParseResult& parsed);
+
+    std::string FormatText(std::span<const uint16_t> code);
+    // out must have room for code.size() * HackText::LineWidth characters. Formats disjoint ranges of large programs on up to jobs threads, 0 meaning one per core
+    void FormatText(std::span<const uint16_t> code, char* out, size_t jobs);
 };
\ No newline at end of file
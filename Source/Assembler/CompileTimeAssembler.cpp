@@ -0,0 +1,78 @@
+#include "CompileTimeAssembler.h"
+
+// Checks the compile-time assembler on every build, against the code the runtime assembler generates for the same programs
+
+using namespace CompileTimeAssembler::Literals;
+
+// Labels, forward references and predefined symbols
+static constexpr std::array Max = CompileTimeAssembler::Assemble<
+    "// Computes R2 = max(R0, R1)\n"
+    "@R0\n"
+    "D=M\n"
+    "@R1\n"
+    "D=D-M\n"
+    "@FIRST\n"
+    "D;JGT\n"
+    "@R1\n"
+    "D=M\n"
+    "@SECOND\n"
+    "0;JMP\n"
+    "(FIRST)\n"
+    "@R0\n"
+    "D=M\n"
+    "(SECOND)\n"
+    "@R2\n"
+    "M=D\n"
+    "(END)\n"
+    "@END\n"
+    "0;JMP\n">();
+
+static_assert(Max == std::array<uint16_t, 16>{
+    0b0000000000000000, 0b1111110000010000, 0b0000000000000001, 0b1111010011010000,
+    0b0000000000001010, 0b1110001100000001, 0b0000000000000001, 0b1111110000010000,
+    0b0000000000001100, 0b1110101010000111, 0b0000000000000000, 0b1111110000010000,
+    0b0000000000000010, 0b1110001100001000, 0b0000000000001110, 0b1110101010000111,
+});
+
+// Variables allocated in order of first use, mixed with labels and device addresses
+static constexpr std::array Variables =
+    "@i\n"
+    "M=1\n"
+    "@sum\n"
+    "M=0\n"
+    "(LOOP)\n"
+    "    @i // indented, with a trailing comment\n"
+    "    D=M\n"
+    "    @SCREEN\n"
+    "    A=D+A\n"
+    "    M=-1\n"
+    "    @sum\n"
+    "    M=D+M\n"
+    "    @i\n"
+    "    M=M+1\n"
+    "    @KBD\n"
+    "    D=M\n"
+    "    @LOOP\n"
+    "    D;JEQ"_hack;
+
+static_assert(Variables == std::array<uint16_t, 17>{
+    0b0000000000010000, 0b1110111111001000, 0b0000000000010001, 0b1110101010001000,
+    0b0000000000010000, 0b1111110000010000, 0b0100000000000000, 0b1110000010100000,
+    0b1110111010001000, 0b0000000000010001, 0b1111000010001000, 0b0000000000010000,
+    0b1111110111001000, 0b0110000000000000, 0b1111110000010000, 0b0000000000000100,
+    0b1110001100000010,
+});
+
+static_assert(CompileTimeAssembler::Assemble<"@32767\n\n// nothing but a comment\n">() == std::array<uint16_t, 1>{ 0b0111111111111111 });
+
+// The first character and label rules of the runtime assembler: nothing up to '9' starts a symbol, ':' does, and a
+// label is followed by the rest of its line
+namespace Detail = CompileTimeAssembler::Detail;
+using CompileTimeAssembler::Errors;
+
+static_assert(Detail::Assemble<1>("@.x").Error == Errors::InvalidSymbol);
+static_assert(Detail::Assemble<1>("@$x").Error == Errors::InvalidSymbol);
+static_assert(Detail::Assemble<0>("(.x)").Error == Errors::InvalidLabel);
+static_assert("@:x"_hack == std::array<uint16_t, 1>{ 0b0000000000010000 });
+static_assert("(L) D=M\n@L"_hack == std::array<uint16_t, 2>{ 0b1111110000010000, 0b0000000000000000 });
+static_assert("(L)D=M\n(END\n@END"_hack == std::array<uint16_t, 2>{ 0b1111110000010000, 0b0000000000000001 });
\ No newline at end of file
@@ -0,0 +1,321 @@
+#pragma once
+
+#include "Language.h"
+#include "Scan.h"
+
+#include <array>
+#include <vector>
+#include <optional>
+#include <string_view>
+#include <algorithm>
+#include <cstdint>
+
+// Assembles programs embedded in C++ sources while compiling, i.e. test fixtures and ROM images:
+//     constexpr std::array rom = CompileTimeAssembler::Assemble<"@2\nD=A\n@0\nM=D">();
+//     constexpr std::array rom = "@2\nD=A\n@0\nM=D"_hack; // with using namespace CompileTimeAssembler::Literals
+// Programs assemble to the same code as on the command line, but compute instructions must use the canonical spellings
+// of Language. Programs with errors fail to compile.
+namespace CompileTimeAssembler {
+    // A string literal as a template argument
+    template <size_t N>
+    struct Source {
+        char Text[N];
+
+        consteval Source(const char (&text)[N]) { std::copy_n(text, N, Text); }
+        constexpr std::string_view View() const { return { Text, N - 1 }; }
+    };
+
+    enum class Errors : uint8_t {
+        None,
+        InvalidLabel,
+        LabelRedefined,
+        InvalidSymbol,
+        InvalidInteger,
+        IntegerOutOfRange,
+        NotCanonical,
+    };
+
+    template <size_t N>
+    struct Result {
+        std::array<uint16_t, N> Code{};
+        // The first error, and the line it is on
+        Errors Error = Errors::None;
+        size_t Line = 0;
+    };
+
+    namespace Detail {
+        constexpr size_t MaxInstructionLength = 12;
+
+        constexpr std::string_view Trim(std::string_view text) {
+            while (!text.empty() && Scan::IsWhitespace(text.front())) text.remove_prefix(1);
+            while (!text.empty() && Scan::IsWhitespace(text.back())) text.remove_suffix(1);
+            return text;
+        }
+
+        // Like in Lexer::GetNextToken, the name of a label is the character after '(' and the symbol characters following it
+        constexpr size_t GetLabelEnd(std::string_view line) {
+            size_t end = std::min<size_t>(2, line.size());
+            while (end < line.size() && Scan::IsSymbol(line[end])) {
+                end++;
+            }
+
+            return end;
+        }
+
+        // Calls line(text, number) for every label and instruction, skipping whitespace and comments. A label takes the
+        // character ending it whatever it is, and the rest of its line is read as more labels and an instruction
+        template <typename F>
+        constexpr void ForEachLine(std::string_view source, F&& line) {
+            for (size_t number = 1; !source.empty(); number++) {
+                const size_t end = std::min(source.find('\n'), source.size());
+                const std::string_view text = Trim(source.substr(0, end));
+                source.remove_prefix(std::min(end + 1, source.size()));
+
+                std::string_view code = Trim(text.substr(0, text.find("//")));
+                while (code.starts_with('(')) {
+                    const size_t labelEnd = std::min(GetLabelEnd(code) + 1, code.size());
+                    line(code.substr(0, labelEnd), number);
+                    code = Trim(code.substr(labelEnd));
+                }
+
+                if (!code.empty()) {
+                    line(code, number);
+                }
+            }
+        }
+
+        constexpr bool IsLabel(std::string_view line) {
+            return line.starts_with('(');
+        }
+
+        template <size_t N>
+        constexpr const Language::Spelling* Find(const std::array<Language::Spelling, N>& spellings, std::string_view text) {
+            for (const Language::Spelling& spelling : spellings) {
+                if (spelling.Text == text) {
+                    return &spelling;
+                }
+            }
+
+            return nullptr;
+        }
+
+        // Register and jump names are their own tokens, and nothing up to '9' starts a symbol, like in SemanticToken::Create
+        constexpr bool IsSymbol(std::string_view name) {
+            if (name.empty() || name.front() - '0' <= 9) {
+                return false;
+            }
+
+            uint8_t registers = 0;
+            bool onlyRegisters = name.size() <= 3;
+            for (char character : name) {
+                if (!Scan::IsSymbol(character)) {
+                    return false;
+                }
+
+                const uint8_t bit = character == 'A' ? 1 : character == 'D' ? 2 : character == 'M' ? 4 : 0;
+                onlyRegisters &= bit != 0 && !(registers & bit);
+                registers |= bit;
+            }
+
+            return !onlyRegisters && !Find(Language::Jumps, name);
+        }
+
+        constexpr std::optional<uint16_t> EncodeCompute(std::string_view line) {
+            // Whitespace may only appear next to operators, like in CanonicalInstructions::TryMatch
+            std::array<char, MaxInstructionLength> buffer{};
+            size_t length = 0;
+            bool afterWhitespace = false;
+            bool afterOperation = true;
+            for (char character : line) {
+                if (Scan::IsWhitespace(character)) {
+                    afterWhitespace = true;
+                    continue;
+                }
+
+                const bool operation = Scan::IsOperation(character);
+                if (length == buffer.size() || (afterWhitespace && !afterOperation && !operation)) {
+                    return std::nullopt;
+                }
+
+                buffer[length++] = character;
+                afterWhitespace = false;
+                afterOperation = operation;
+            }
+
+            std::string_view instruction(buffer.data(), length);
+            const size_t assignment = instruction.find('=');
+            const size_t jump = instruction.find(';');
+
+            const std::string_view destinationText = assignment == std::string_view::npos ? "" : instruction.substr(0, assignment);
+            const std::string_view jumpText = jump == std::string_view::npos ? "" : instruction.substr(jump + 1);
+            instruction = instruction.substr(0, jump);
+            instruction = assignment == std::string_view::npos ? instruction : instruction.substr(assignment + 1);
+
+            const Language::Spelling* destination = Find(Language::Destinations, destinationText);
+            const Language::Spelling* comparison = Find(Language::Comparisons, instruction);
+            const Language::Spelling* condition = Find(Language::Jumps, jumpText);
+            if (!destination || !comparison || !condition || (assignment != std::string_view::npos && destinationText.empty())
+                || (jump != std::string_view::npos && jumpText.empty()) || !Language::IsAccepted(*destination, *comparison, *condition)) {
+                return std::nullopt;
+            }
+
+            return Language::Encode(*destination, *comparison, *condition);
+        }
+
+        constexpr size_t CountInstructions(std::string_view source) {
+            size_t count = 0;
+            ForEachLine(source, [&](std::string_view line, size_t) { count += !IsLabel(line); });
+            return count;
+        }
+
+        struct Line {
+            std::string_view Text;
+            size_t Number;
+        };
+
+        struct Symbol {
+            std::string_view Name;
+            uint16_t Value;
+        };
+
+        // Labels are collected in a first pass, so that symbols are variables only if no label of that name exists anywhere
+        template <size_t N>
+        constexpr Result<N> Assemble(std::string_view source) {
+            Result<N> program;
+            auto fail = [&](Errors error, size_t number) {
+                if (program.Error == Errors::None) {
+                    program.Error = error;
+                    program.Line = number;
+                }
+            };
+
+            // Sorted by name, linear searches run into the limits compilers put on constant evaluation
+            std::vector<Symbol> symbols;
+            auto lowerBound = [&](std::string_view name) {
+                size_t first = 0;
+                for (size_t count = symbols.size(); count > 0;) {
+                    const size_t half = count / 2;
+                    if (symbols[first + half].Name < name) {
+                        first += half + 1;
+                        count -= half + 1;
+                    }
+                    else {
+                        count = half;
+                    }
+                }
+
+                return symbols.begin() + static_cast<ptrdiff_t>(first);
+            };
+
+            auto find = [&](std::string_view name) {
+                auto symbol = lowerBound(name);
+                return symbol != symbols.end() && symbol->Name == name ? symbol : symbols.end();
+            };
+
+            auto add = [&](std::string_view name, uint16_t value) {
+                symbols.insert(lowerBound(name), Symbol{ name, value });
+            };
+
+            for (const auto& symbol : Language::PredefinedSymbols) {
+                add(symbol.Name, symbol.Value);
+            }
+
+            // Both passes go over the lines split once, constant evaluation is slow enough for it to matter
+            std::vector<Line> lines;
+            ForEachLine(source, [&](std::string_view line, size_t number) { lines.push_back(Line{ line, number }); });
+
+            auto forEachLine = [&](auto&& line) {
+                for (const Line& entry : lines) {
+                    line(entry.Text, entry.Number);
+                }
+            };
+
+            uint16_t address = 0;
+            forEachLine([&](std::string_view line, size_t number) {
+                if (!IsLabel(line)) {
+                    address++;
+                    return;
+                }
+
+                const std::string_view name = line.substr(1, GetLabelEnd(line) - 1);
+                if (!IsSymbol(name)) {
+                    return fail(Errors::InvalidLabel, number);
+                }
+
+                if (find(name) != symbols.end()) {
+                    return fail(Errors::LabelRedefined, number);
+                }
+
+                add(name, address);
+            });
+
+            size_t count = 0;
+            uint16_t variableAddress = Language::FirstVariableAddress;
+            forEachLine([&](std::string_view line, size_t number) {
+                if (IsLabel(line)) {
+                    return;
+                }
+
+                uint16_t& code = program.Code[count++];
+                if (!line.starts_with('@')) {
+                    const auto encoded = EncodeCompute(line);
+                    return encoded.has_value() ? void(code = encoded.value()) : fail(Errors::NotCanonical, number);
+                }
+
+                const std::string_view operand = Trim(line.substr(1));
+                if (!operand.empty() && Scan::IsNumeric(operand.front())) {
+                    uint32_t value = 0;
+                    for (char digit : operand) {
+                        if (!Scan::IsNumeric(digit)) {
+                            return fail(Errors::InvalidInteger, number);
+                        }
+
+                        value = value * 10 + static_cast<uint32_t>(digit - '0');
+                        if (value > UINT16_MAX) {
+                            return fail(Errors::IntegerOutOfRange, number);
+                        }
+                    }
+
+                    code = static_cast<uint16_t>(value);
+                    return;
+                }
+
+                if (!IsSymbol(operand)) {
+                    return fail(Errors::InvalidSymbol, number);
+                }
+
+                auto symbol = find(operand);
+                if (symbol != symbols.end()) {
+                    code = symbol->Value;
+                    return;
+                }
+
+                code = variableAddress++;
+                add(operand, code);
+            });
+
+            return program;
+        }
+    }
+
+    // Fails to compile if the program has an error. Compilers show the values compared by a failed assertion, which gives the line
+    template <Source S>
+    consteval auto Assemble() {
+        constexpr auto program = Detail::Assemble<Detail::CountInstructions(S.View())>(S.View());
+        static_assert(program.Error != Errors::InvalidLabel, "Not a valid label");
+        static_assert(program.Error != Errors::LabelRedefined, "Label has already been defined");
+        static_assert(program.Error != Errors::InvalidSymbol, "Not a valid symbol");
+        static_assert(program.Error != Errors::InvalidInteger, "Not a valid integer");
+        static_assert(program.Error != Errors::IntegerOutOfRange, "Integer is out of range for 16 bit unsigned integer");
+        static_assert(program.Error != Errors::NotCanonical, "Not a compute instruction in canonical spelling");
+        static_assert(program.Line == 0, "The error is on this line");
+        return program.Code;
+    }
+
+    namespace Literals {
+        template <Source S>
+        consteval auto operator""_hack() {
+            return Assemble<S>();
+        }
+    }
+}
\ No newline at end of file
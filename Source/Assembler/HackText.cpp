@@ -0,0 +1,235 @@
+#include "HackText.h"
+
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define HACK_TEXT_X64
+    #include <immintrin.h>
+
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        // MSVC allows every intrinsic in any function
+        #define HACK_TEXT_TARGET(features)
+    #else
+        #define HACK_TEXT_TARGET(features) __attribute__((target(features)))
+    #endif
+#endif
+
+// Digits of every byte value, most significant bit first
+static constexpr auto ByteDigits = [] {
+    std::array<std::array<char, 8>, 256> digits{};
+    for (size_t value = 0; value < digits.size(); value++) {
+        for (size_t bit = 0; bit < 8; bit++) {
+            digits[value][bit] = static_cast<char>('0' + ((value >> (7 - bit)) & 1));
+        }
+    }
+
+    return digits;
+}();
+
+static inline void EncodeLineEnding(char* out) {
+    std::memcpy(out + 16, HackText::LineEnding.data(), HackText::LineEnding.size());
+}
+
+static void EncodeScalar(std::span<const uint16_t> words, char* out) {
+    for (uint16_t word : words) {
+        std::memcpy(out, ByteDigits[word >> 8].data(), 8);
+        std::memcpy(out + 8, ByteDigits[word & 0xFF].data(), 8);
+        EncodeLineEnding(out);
+        out += HackText::LineWidth;
+    }
+}
+
+// Returns the word, or -1 if the 16 characters are not all binary digits
+static int DecodeScalar(const char* line) {
+    int word = 0;
+    for (size_t i = 0; i < 16; i++) {
+        const unsigned digit = static_cast<unsigned char>(line[i]) - '0';
+        if (digit > 1) {
+            return -1;
+        }
+
+        word = word << 1 | static_cast<int>(digit);
+    }
+
+    return word;
+}
+
+#ifdef HACK_TEXT_X64
+
+static constexpr uint64_t LowBits = 0x0101010101010101;
+static constexpr uint64_t Zeros = 0x3030303030303030;
+
+// Deposits the bits of a byte into the low bit of each byte, then reverses the bytes so that the most significant bit comes first
+HACK_TEXT_TARGET("bmi2") static void EncodeBmi2(std::span<const uint16_t> words, char* out) {
+    for (uint16_t word : words) {
+        const uint64_t high = std::byteswap(_pdep_u64(word >> 8, LowBits)) | Zeros;
+        const uint64_t low = std::byteswap(_pdep_u64(word & 0xFF, LowBits)) | Zeros;
+        std::memcpy(out, &high, 8);
+        std::memcpy(out + 8, &low, 8);
+        EncodeLineEnding(out);
+        out += HackText::LineWidth;
+    }
+}
+
+HACK_TEXT_TARGET("bmi2") static int DecodeBmi2(const char* line) {
+    uint64_t high, low;
+    std::memcpy(&high, line, 8);
+    std::memcpy(&low, line + 8, 8);
+    high -= Zeros;
+    low -= Zeros;
+
+    // Anything but '0' and '1' leaves (or borrows into) bits other than the lowest of its byte
+    if ((high | low) & ~LowBits) {
+        return -1;
+    }
+
+    return static_cast<int>(_pext_u64(std::byteswap(high), LowBits) << 8 | _pext_u64(std::byteswap(low), LowBits));
+}
+
+// Broadcasts the high byte of the word to the first eight lanes and the low byte to the rest,
+// then turns the lanes whose bit is set into '1' by subtracting the all ones compare result from '0'
+HACK_TEXT_TARGET("ssse3") static void EncodeSsse3(std::span<const uint16_t> words, char* out) {
+    const __m128i spread = _mm_setr_epi8(1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i bits = _mm_set1_epi64x(static_cast<long long>(0x0102040810204080));
+    const __m128i zeros = _mm_set1_epi8('0');
+
+    for (uint16_t word : words) {
+        const __m128i lanes = _mm_and_si128(_mm_shuffle_epi8(_mm_cvtsi32_si128(word), spread), bits);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_sub_epi8(zeros, _mm_cmpeq_epi8(lanes, bits)));
+        EncodeLineEnding(out);
+        out += HackText::LineWidth;
+    }
+}
+
+HACK_TEXT_TARGET("ssse3") static int DecodeSsse3(const char* line) {
+    const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    const __m128i ones = _mm_set1_epi8(1);
+
+    const __m128i digits = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(line)), _mm_set1_epi8('0'));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(digits, ones), ones)) != 0xFFFF) {
+        return -1;
+    }
+
+    // Moves the last digit to the first lane, and every digit to the top bit of its lane
+    return _mm_movemask_epi8(_mm_slli_epi16(_mm_shuffle_epi8(digits, reverse), 7));
+}
+
+struct CpuFeatures {
+    bool Bmi2 = false;
+    bool Ssse3 = false;
+};
+
+static CpuFeatures DetectCpuFeatures() {
+    CpuFeatures features;
+#ifdef _MSC_VER
+    int registers[4];
+    __cpuid(registers, 0);
+    const int maxLeaf = registers[0];
+
+    __cpuid(registers, 1);
+    features.Ssse3 = registers[2] & (1 << 9);
+
+    if (maxLeaf >= 7) {
+        __cpuidex(registers, 7, 0);
+        features.Bmi2 = registers[1] & (1 << 8);
+    }
+#else
+    __builtin_cpu_init();
+    features.Bmi2 = __builtin_cpu_supports("bmi2");
+    features.Ssse3 = __builtin_cpu_supports("ssse3");
+#endif
+    return features;
+}
+
+#endif
+
+bool HackText::IsSupported(Kernel kernel) {
+#ifdef HACK_TEXT_X64
+    static const CpuFeatures features = DetectCpuFeatures();
+    switch (kernel) {
+    case Kernel::Scalar: return true;
+    case Kernel::Bmi2: return features.Bmi2;
+    case Kernel::Ssse3: return features.Ssse3;
+    }
+
+    return false;
+#else
+    return kernel == Kernel::Scalar;
+#endif
+}
+
+HackText::Kernel HackText::GetKernel() {
+    // PDEP and PEXT are microcoded and slow on AMD before Zen 3, the shuffles are fast everywhere
+    static const Kernel kernel = IsSupported(Kernel::Ssse3) ? Kernel::Ssse3
+        : IsSupported(Kernel::Bmi2) ? Kernel::Bmi2
+        : Kernel::Scalar;
+    return kernel;
+}
+
+std::string_view HackText::GetName(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Scalar: return "scalar";
+    case Kernel::Bmi2: return "bmi2";
+    case Kernel::Ssse3: return "ssse3";
+    }
+
+    return "unknown";
+}
+
+void HackText::Encode(std::span<const uint16_t> words, char* out) {
+    Encode(words, out, GetKernel());
+}
+
+void HackText::Encode(std::span<const uint16_t> words, char* out, Kernel kernel) {
+    switch (kernel) {
+#ifdef HACK_TEXT_X64
+    case Kernel::Bmi2: return EncodeBmi2(words, out);
+    case Kernel::Ssse3: return EncodeSsse3(words, out);
+#endif
+    default: return EncodeScalar(words, out);
+    }
+}
+
+std::expected<std::vector<uint16_t>, size_t> HackText::Decode(std::string_view text) {
+    return Decode(text, GetKernel());
+}
+
+std::expected<std::vector<uint16_t>, size_t> HackText::Decode(std::string_view text, Kernel kernel) {
+    int (*decodeLine)(const char*) = DecodeScalar;
+#ifdef HACK_TEXT_X64
+    decodeLine = kernel == Kernel::Bmi2 ? DecodeBmi2 : kernel == Kernel::Ssse3 ? DecodeSsse3 : DecodeScalar;
+#endif
+
+    std::vector<uint16_t> words;
+    words.reserve(text.size() / (16 + 1) + 1);
+
+    for (size_t position = 0; position < text.size();) {
+        const size_t line = words.size() + 1;
+        if (text.size() - position < 16) {
+            return std::unexpected(line);
+        }
+
+        const int word = decodeLine(text.data() + position);
+        if (word < 0) {
+            return std::unexpected(line);
+        }
+
+        words.push_back(static_cast<uint16_t>(word));
+        position += 16;
+
+        if (text.substr(position).starts_with("\r\n")) {
+            position += 2;
+        }
+        else if (text.substr(position).starts_with('\n')) {
+            position += 1;
+        }
+        else if (position != text.size()) {
+            return std::unexpected(line);
+        }
+    }
+
+    return words;
+}
\ No newline at end of file
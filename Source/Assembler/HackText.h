@@ -0,0 +1,39 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <string_view>
+#include <expected>
+#include <cstdint>
+
+// The .hack text format: one word per line, as 16 binary digits with the most significant bit first.
+// Both directions have vectorized kernels, picked once at runtime from the features of the CPU.
+namespace HackText {
+    // The line ending a text mode stream would write on this platform. Decode accepts either
+#ifdef _WIN32
+    constexpr std::string_view LineEnding = "\r\n";
+#else
+    constexpr std::string_view LineEnding = "\n";
+#endif
+
+    constexpr size_t LineWidth = 16 + LineEnding.size();
+
+    enum class Kernel : uint8_t {
+        Scalar,
+        Bmi2,
+        Ssse3,
+    };
+
+    bool IsSupported(Kernel kernel);
+    // The fastest supported kernel
+    Kernel GetKernel();
+    std::string_view GetName(Kernel kernel);
+
+    // out must have room for words.size() * LineWidth characters
+    void Encode(std::span<const uint16_t> words, char* out);
+    void Encode(std::span<const uint16_t> words, char* out, Kernel kernel);
+
+    // Every line must have exactly 16 digits, only the last one may lack a line ending. On error returns the line number
+    std::expected<std::vector<uint16_t>, size_t> Decode(std::string_view text);
+    std::expected<std::vector<uint16_t>, size_t> Decode(std::string_view text, Kernel kernel);
+}
\ No newline at end of file
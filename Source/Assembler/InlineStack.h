@@ -0,0 +1,43 @@
+#pragma once
+
+#include <span>
+#include <memory>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+// Fixed capacity stack stored inline, for trivially copyable elements.
+// Pushing to a full stack replaces the top element, so a stack with one slot more than the 
+// longest valid sequence still tells an over-long sequence apart and knows its last element.
+template <typename T, size_t Capacity>
+class InlineStack {
+    static_assert(std::is_trivially_copyable_v<T>);
+public:
+    constexpr InlineStack() {}
+
+    constexpr void push_back(const T& value) {
+        m_Size -= full();
+        std::construct_at(m_Data + m_Size++, value);
+    }
+
+    constexpr void clear() { m_Size = 0; }
+
+    constexpr size_t size() const { return m_Size; }
+    constexpr bool empty() const { return m_Size == 0; }
+    constexpr bool full() const { return m_Size == Capacity; }
+
+    constexpr const T* data() const { return m_Data; }
+    constexpr const T* begin() const { return m_Data; }
+    constexpr const T* end() const { return m_Data + m_Size; }
+
+    constexpr const T& front() const { assert(!empty()); return m_Data[0]; }
+    constexpr const T& back() const { assert(!empty()); return m_Data[m_Size - 1]; }
+    constexpr const T& operator[](size_t index) const { assert(index < m_Size); return m_Data[index]; }
+
+    constexpr operator std::span<const T>() const { return { m_Data, m_Size }; }
+private:
+    size_t m_Size = 0;
+    union {
+        T m_Data[Capacity];
+    };
+};
@@ -60,7 +60,7 @@ std::expected<ComputeInstruction, Instructions::ParseError> Validate(ComputeInst
 }
 
 std::expected<ComputeInstruction, Instructions::ParseError> ComputeInstruction::Create(std::span<const SemanticToken> semanticStack) {
-    if (1 >= semanticStack.size() || semanticStack.size() > 7){
+    if (1 >= semanticStack.size() || semanticStack.size() > MaxTokens){
         return std::unexpected<Instructions::ParseError>(std::in_place, Instructions::ParseError::InvalidSemanticTokenCount, -1);
     }
 
@@ -235,22 +235,22 @@ std::string ComputeInstruction::ToString() const {
     return std::format("{}{}{}{}{}{}", destinationToString(Destination), eq, operandToString(Comparison.Left), operationToString(Comparison.Operation), operandToString(Comparison.Right), jumpToString(Jump));
 }
 
-std::expected<AddressingInstruction, Instructions::ParseError> AddressingInstruction::Create(const SemanticToken& semantic) {
+std::expected<AddressingInstruction, Instructions::ParseError> AddressingInstruction::Create(const SemanticToken& semantic, SymbolMap& symbols) {
     if (const uint16_t* integer = semantic.TryGetData<uint16_t>(); integer) {
         return AddressingInstruction{ *integer };
     }
 
-    if (const std::string* variable = semantic.TryGetData<std::string>(); variable) {
-        return AddressingInstruction{ *variable };
+    if (const std::string_view* variable = semantic.TryGetData<std::string_view>(); variable) {
+        return AddressingInstruction{ symbols.Intern(*variable) };
     }
 
     return std::unexpected<Instructions::ParseError>(std::in_place, Instructions::ParseError::InvalidSemanticTokenType, 0);
 }
 
 std::string AddressingInstruction::ToString() const {
-    return std::visit([](const auto& obj) { return std::format("Load {}", obj); }, Variable);
-}
+    if (const SymbolId* symbol = std::get_if<SymbolId>(&Variable); symbol) {
+        return std::format("Load symbol #{}", symbol->Index);
+    }
 
-std::string LoadInstruction::ToString() const {
-    return std::format("Load {}", value);
+    return std::format("Load {}", std::get<uint16_t>(Variable));
 }
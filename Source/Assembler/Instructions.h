@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SemanticToken.h"
+#include "SymbolMap.h"
 
 #include <string>
 #include <span>
@@ -54,20 +55,16 @@ struct ComputeInstruction {
     Comparison Comparison;
     Jumps Jump;
 
+    static constexpr size_t MaxTokens = 7; // i.e. "AMD = D | M ; JMP"
 
     static std::expected<ComputeInstruction, Instructions::ParseError> Create(std::span<const SemanticToken> semanticTokens);
     std::string ToString() const;
 };
 
 struct AddressingInstruction {
-    std::variant<std::string, uint16_t> Variable;
-
-    static std::expected<AddressingInstruction, Instructions::ParseError> Create(const SemanticToken& semanticToken);
-    std::string ToString() const;
-};
-
-struct LoadInstruction {
-    uint16_t value;
+    std::variant<SymbolId, uint16_t> Variable;
 
+    // Variable names are interned into symbols
+    static std::expected<AddressingInstruction, Instructions::ParseError> Create(const SemanticToken& semanticToken, SymbolMap& symbols);
     std::string ToString() const;
 };
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <cstdint>
+
+// The fixed vocabulary of the Hack assembly language, shared by the tables built from it at compile time
+namespace Language {
+    struct Spelling {
+        std::string_view Text;
+        uint16_t Code;
+    };
+
+    constexpr std::array<Spelling, 16> Destinations{{
+        { "", 0b000 },
+        { "M", 0b001 },   { "D", 0b010 },   { "A", 0b100 },
+        { "DM", 0b011 },  { "MD", 0b011 },
+        { "AM", 0b101 },  { "MA", 0b101 },
+        { "AD", 0b110 },  { "DA", 0b110 },
+        { "ADM", 0b111 }, { "AMD", 0b111 }, { "DAM", 0b111 }, { "DMA", 0b111 }, { "MAD", 0b111 }, { "MDA", 0b111 },
+    }};
+
+    // The canonical spellings. Registers may only appear on the right side of a binary operator after D, and numbers only on the right side
+    constexpr std::array<Spelling, 28> Comparisons{{
+        { "0",   0b0101010 }, { "1",   0b0111111 }, { "-1",  0b0111010 },
+        { "D",   0b0001100 }, { "A",   0b0110000 }, { "M",   0b1110000 },
+        { "!D",  0b0001101 }, { "!A",  0b0110001 }, { "!M",  0b1110001 },
+        { "-D",  0b0001111 }, { "-A",  0b0110011 }, { "-M",  0b1110011 },
+        { "D+1", 0b0011111 }, { "A+1", 0b0110111 }, { "M+1", 0b1110111 },
+        { "D-1", 0b0001110 }, { "A-1", 0b0110010 }, { "M-1", 0b1110010 },
+        { "D+A", 0b0000010 }, { "D+M", 0b1000010 },
+        { "D-A", 0b0010011 }, { "D-M", 0b1010011 },
+        { "A-D", 0b0000111 }, { "M-D", 0b1000111 },
+        { "D&A", 0b0000000 }, { "D&M", 0b1000000 },
+        { "D|A", 0b0010101 }, { "D|M", 0b1010101 },
+    }};
+
+    constexpr std::array<Spelling, 8> Jumps{{
+        { "", 0b000 },
+        { "JGT", 0b001 }, { "JEQ", 0b010 }, { "JGE", 0b011 }, { "JLT", 0b100 }, { "JNE", 0b101 }, { "JLE", 0b110 }, { "JMP", 0b111 },
+    }};
+
+    constexpr bool IsUnary(const Spelling& comparison) {
+        return comparison.Text.starts_with('-') || comparison.Text.starts_with('!');
+    }
+
+    // An instruction must have a destination or a jump. Jumps without a destination are left to the parser
+    // when they are unary (i.e. "-D;JGT"), which ComputeInstruction::Create rejects, or the constant one,
+    // which it encodes as "0;JGT". Tables of these spellings must not change the output of any program
+    constexpr bool IsAccepted(const Spelling& destination, const Spelling& comparison, const Spelling& jump) {
+        return !destination.Text.empty() || (!jump.Text.empty() && !IsUnary(comparison) && comparison.Text != "1");
+    }
+
+    constexpr uint16_t Encode(const Spelling& destination, const Spelling& comparison, const Spelling& jump) {
+        return static_cast<uint16_t>(0b111 << 13 | comparison.Code << 6 | destination.Code << 3 | jump.Code);
+    }
+
+    struct PredefinedSymbol {
+        std::string_view Name;
+        uint16_t Value;
+    };
+
+    constexpr std::array<PredefinedSymbol, 23> PredefinedSymbols{{
+        { "SP",     0x0 },
+        { "LCL",    0x1 },
+        { "ARG",    0x2 },
+        { "THIS",   0x3 },
+        { "THAT",   0x4 },
+        { "SCREEN", 0x4000 },
+        { "KBD",    0x6000 },
+        { "R0", 0 },  { "R1", 1 },  { "R2", 2 },   { "R3", 3 },   { "R4", 4 },   { "R5", 5 },   { "R6", 6 },   { "R7", 7 },
+        { "R8", 8 },  { "R9", 9 },  { "R10", 10 }, { "R11", 11 }, { "R12", 12 }, { "R13", 13 }, { "R14", 14 }, { "R15", 15 },
+    }};
+
+    // Variables are allocated from here up, in order of first use
+    constexpr uint16_t FirstVariableAddress = 16;
+}
\ No newline at end of file
@@ -1,95 +1,60 @@
 #include "Lexer.h"
+#include "Scan.h"
 
-#include <istream>
-
-enum class State : uint8_t {
-    None = 0,
-    Comment,
-    Operation,
-    Label,
-    Integer,
-    String,
-    Terminal,
-    Newline,
-};
-
-static constexpr bool IsOperation(char character) {
-    return character == '=' || character == ';' || character == '!' || character == '+' || character == '-' || character == '&' || character == '|';
-}
-
-static constexpr bool IsNumeric(char character) {
-    return '0' <= character && character <= '9';
-}
-
-static constexpr bool IsAlpha(char character) {
-    character &= ~32;
-    return 'A' <= character && character <= 'Z';
-}
-
-static constexpr bool IsSpecial(char character) {
-    return  character == '_' || character == '.' || character == '$' || character == ':';
+static constexpr bool IsComment(std::string_view stream, size_t position) {
+    return stream[position] == '/' && position + 1 < stream.size() && stream[position + 1] == '/';
 }
 
-static constexpr bool IsSymbol(char character) {
-    return IsNumeric(character) || IsAlpha(character) || IsSpecial(character);
+static constexpr bool IsTokenStart(std::string_view stream, size_t position) {
+    char character = stream[position];
+    return character == '\n' || character == '(' || Scan::IsOperation(character) || Scan::IsSymbol(character) || IsComment(stream, position);
 }
 
-Lexer::Token Lexer::GetNextToken(std::istream& stream) {
-    std::string token;
-    char character;
-    State state = State::None;
-    TokenType tokenType = TokenType::EndOfStream;
-    uint32_t charactersConsumed = 0;
-
-    while (state != State::Terminal && stream.get(character).good()) {
-        charactersConsumed++;
-
-        switch (state) {
-        case State::None:
-            if (character == '\n') { state = State::Newline; }
-            else if (character == '/' && stream.peek() == '/') {  state = State::Comment; }
-            else if (IsOperation(character)) { state = State::Operation; }
-            else if (character == '(') { stream.get(character); state = State::Label; }
-            else if (IsNumeric(character)) { state = State::Integer; }
-            else if (IsAlpha(character) || IsSpecial(character)) { state = State::String; }
-
-            tokenType = TokenType::Value(TokenType::Invalid + (uint8_t)state);
-            break;
-        case State::Comment:
-            state = (character == '\n') ? State::Terminal : state;
-            break;
-        case State::Newline:
-        case State::Operation:
-            state = State::Terminal;
-            break;
-        case State::Label:
-            if (!IsSymbol(character)) {
-                state = State::Terminal;
-                stream.get();
-                charactersConsumed += 2; // Accounts for ( and ) characters
-            }
-            break;
-        case State::Integer:
-            state = !IsNumeric(character) ? State::Terminal : state;
-            break;
-        case State::String:
-            state = !IsSymbol(character) ? State::Terminal : state;
-            break;
-        case State::Terminal:
-            assert(false); // This should never be reached
-            break;
-        }
+Lexer::Token Lexer::GetNextToken(std::string_view& stream) {
+    // Characters that can not start a token (whitespace, '@', stray punctuation) are skipped, but still consumed
+    size_t position = Scan::SkipWhitespace(stream, 0);
+    while (position < stream.size() && !IsTokenStart(stream, position)) {
+        position = Scan::SkipWhitespace(stream, position + 1);
+    }
 
-        if (state == State::Terminal) {
-            stream.unget();
-            charactersConsumed--;
-            break;
-        }
+    if (position == stream.size()) {
+        stream.remove_prefix(position);
+        return { TokenType::EndOfStream, static_cast<uint32_t>(position), {} };
+    }
 
-        if (state != State::None && state != State::Terminal) {
-            token.append(1, character);
+    TokenType tokenType = TokenType::Invalid;
+    size_t tokenStart = position;
+    size_t tokenEnd = position + 1;
+    size_t end = tokenEnd;
+    size_t charactersConsumed = tokenEnd;
+
+    char character = stream[position];
+    if (character == '\n') {
+        tokenType = TokenType::Newline;
+    } else if (IsComment(stream, position)) {
+        tokenType = TokenType::Comment;
+        end = charactersConsumed = tokenEnd = Scan::FindNewline(stream, position + 2);
+    } else if (Scan::IsOperation(character)) {
+        tokenType = TokenType::Operation;
+    } else if (character == '(') {
+        tokenType = TokenType::Label;
+
+        // The character after ( is part of the label whatever it is. The character ending the label is consumed with it,
+        // unless the line ends there, which leaves the newline for its own token
+        if (position + 1 < stream.size() && stream[position + 1] != '\n') {
+            tokenStart = position + 1;
+            tokenEnd = Scan::SkipSymbol(stream, position + 2);
+            end = charactersConsumed = tokenEnd + (tokenEnd < stream.size() && stream[tokenEnd] != '\n');
         }
+    } else if (Scan::IsNumeric(character)) {
+        tokenType = TokenType::Integer;
+        end = charactersConsumed = tokenEnd = Scan::SkipInteger(stream, position + 1);
+    } else {
+        tokenType = TokenType::String;
+        end = charactersConsumed = tokenEnd = Scan::SkipSymbol(stream, position + 1);
     }
 
-    return { tokenType, charactersConsumed, token };
+    Token token = { tokenType, static_cast<uint32_t>(charactersConsumed), stream.substr(tokenStart, tokenEnd - tokenStart) };
+    stream.remove_prefix(end);
+    return token;
 }
@@ -55,9 +55,10 @@ namespace Lexer {
     struct Token {
         TokenType Type;
         uint32_t CharactersConsumed;
-        std::string Data;
+        std::string_view Data;
     };
 
-    Token GetNextToken(std::istream& stream);
+    // Consumes the next token from the front of stream. Data is a view into the same buffer as stream
+    Token GetNextToken(std::string_view& stream);
 };
 
@@ -0,0 +1,169 @@
+#include "OutputFormat.h"
+#include "CodeGeneration.h"
+#include "Trace.h"
+
+#include <array>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+static constexpr auto Crc32Table = [] {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < table.size(); i++) {
+        uint32_t crc = i;
+        for (size_t bit = 0; bit < 8; bit++) {
+            crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+        }
+
+        table[i] = crc;
+    }
+
+    return table;
+}();
+
+static constexpr uint16_t ToLittleEndian(uint16_t word) {
+    return std::endian::native == std::endian::little ? word : std::byteswap(word);
+}
+
+static char* WriteWords(std::span<const uint16_t> code, char* out) {
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(out, code.data(), code.size_bytes());
+        return out + code.size_bytes();
+    }
+
+    for (uint16_t word : code) {
+        word = ToLittleEndian(word);
+        std::memcpy(out, &word, sizeof(word));
+        out += sizeof(word);
+    }
+
+    return out;
+}
+
+// Records are ":", the byte count, the address, the type, the data and the checksum of all of them, in hexadecimal digits
+static constexpr size_t HexBytesPerRecord = 16;
+static constexpr size_t HexRecordWidth = 1 + 2 + 4 + 2 + 2 + HackText::LineEnding.size();
+static constexpr size_t HexSegmentSize = 1 << 16;
+
+enum HexRecord : uint8_t {
+    Data = 0x00,
+    EndOfFile = 0x01,
+    ExtendedLinearAddress = 0x04,
+};
+
+static char* WriteHexRecord(char* out, HexRecord type, uint16_t address, std::span<const uint8_t> data) {
+    constexpr std::string_view Digits = "0123456789ABCDEF";
+
+    uint8_t checksum = 0;
+    auto writeByte = [&](uint8_t byte) {
+        *out++ = Digits[byte >> 4];
+        *out++ = Digits[byte & 0xF];
+        checksum += byte;
+    };
+
+    *out++ = ':';
+    writeByte(static_cast<uint8_t>(data.size()));
+    writeByte(static_cast<uint8_t>(address >> 8));
+    writeByte(static_cast<uint8_t>(address));
+    writeByte(type);
+    for (uint8_t byte : data) {
+        writeByte(byte);
+    }
+
+    writeByte(static_cast<uint8_t>(-checksum));
+    return std::ranges::copy(HackText::LineEnding, out).out;
+}
+
+static void WriteIntelHex(std::span<const uint16_t> code, char* out) {
+    std::array<uint8_t, HexBytesPerRecord> data;
+    for (size_t address = 0; address < code.size_bytes(); address += HexBytesPerRecord) {
+        if (address != 0 && address % HexSegmentSize == 0) {
+            const uint16_t segment = static_cast<uint16_t>(address / HexSegmentSize);
+            const std::array<uint8_t, 2> upper = { static_cast<uint8_t>(segment >> 8), static_cast<uint8_t>(segment) };
+            out = WriteHexRecord(out, HexRecord::ExtendedLinearAddress, 0, upper);
+        }
+
+        const size_t count = std::min(HexBytesPerRecord, code.size_bytes() - address);
+        WriteWords(code.subspan(address / 2, count / 2), reinterpret_cast<char*>(data.data()));
+        out = WriteHexRecord(out, HexRecord::Data, static_cast<uint16_t>(address), std::span(data).first(count));
+    }
+
+    WriteHexRecord(out, HexRecord::EndOfFile, 0, {});
+}
+
+std::string_view OutputFormat::GetExtension(Format format) {
+    switch (format) {
+    case Format::Text: return ".hack";
+    case Format::Raw: return ".bin";
+    case Format::Image: return ".himg";
+    case Format::IntelHex: return ".hex";
+    }
+
+    return "";
+}
+
+uint32_t OutputFormat::Crc32(std::span<const uint16_t> code) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (uint16_t word : code) {
+        crc = (crc >> 8) ^ Crc32Table[(crc ^ word) & 0xFF];
+        crc = (crc >> 8) ^ Crc32Table[(crc ^ (word >> 8)) & 0xFF];
+    }
+
+    return ~crc;
+}
+
+size_t OutputFormat::GetSize(std::span<const uint16_t> code, Format format) {
+    switch (format) {
+    case Format::Text: return code.size() * HackText::LineWidth;
+    case Format::Raw: return code.size_bytes();
+    case Format::Image: return sizeof(ImageHeader) + code.size_bytes();
+    case Format::IntelHex: {
+        const size_t records = (code.size_bytes() + HexBytesPerRecord - 1) / HexBytesPerRecord;
+        const size_t segments = (code.size_bytes() + HexSegmentSize - 1) / HexSegmentSize;
+        const size_t addressRecords = segments > 1 ? segments - 1 : 0;
+        return (records + 1) * HexRecordWidth + 2 * code.size_bytes() + addressRecords * (HexRecordWidth + 4);
+    }
+    }
+
+    return 0;
+}
+
+std::string OutputFormat::Write(std::span<const uint16_t> code, Format format) {
+    std::string output(GetSize(code, format), '\0');
+    Write(code, format, output.data(), 1);
+    return output;
+}
+
+void OutputFormat::Write(std::span<const uint16_t> code, Format format, char* out, size_t jobs) {
+    Trace::Zone zone("format output", GetExtension(format));
+    switch (format) {
+    case Format::Text:
+        CodeGeneration::FormatText(code, out, jobs);
+        return;
+    case Format::Raw:
+        WriteWords(code, out);
+        return;
+    case Format::Image: {
+        ImageHeader header = {
+            .Magic = {},
+            .Version = ToLittleEndian(ImageVersion),
+            .HeaderSize = ToLittleEndian(sizeof(ImageHeader)),
+            .Count = static_cast<uint32_t>(code.size()),
+            .Checksum = Crc32(code),
+        };
+
+        if constexpr (std::endian::native != std::endian::little) {
+            header.Count = std::byteswap(header.Count);
+            header.Checksum = std::byteswap(header.Checksum);
+        }
+
+        ImageMagic.copy(header.Magic, sizeof(header.Magic));
+        std::memcpy(out, &header, sizeof(header));
+        WriteWords(code, out + sizeof(header));
+        return;
+    }
+    case Format::IntelHex:
+        WriteIntelHex(code, out);
+        return;
+    }
+}
\ No newline at end of file
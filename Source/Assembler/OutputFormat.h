@@ -0,0 +1,43 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+// Formats of the assembled program. Binary formats store every word little endian
+namespace OutputFormat {
+    enum class Format : uint8_t {
+        // One line of 16 binary digits per word, see HackText
+        Text,
+        // Only the words
+        Raw,
+        // ImageHeader followed by the words, which start aligned for loaders that map the file
+        Image,
+        // Data records of 16 bytes, with extended linear address records past 64 KiB
+        IntelHex,
+    };
+
+    constexpr std::string_view ImageMagic = "HACK";
+    constexpr uint16_t ImageVersion = 1;
+
+    struct ImageHeader {
+        char Magic[4];
+        uint16_t Version;
+        uint16_t HeaderSize;
+        uint32_t Count;
+        // CRC-32 of the words as stored
+        uint32_t Checksum;
+    };
+
+    static_assert(sizeof(ImageHeader) == 16);
+
+    std::string_view GetExtension(Format format);
+
+    uint32_t Crc32(std::span<const uint16_t> code);
+
+    size_t GetSize(std::span<const uint16_t> code, Format format);
+    std::string Write(std::span<const uint16_t> code, Format format);
+    // out must have room for GetSize characters. Text is formatted on up to jobs threads, 0 meaning one per core
+    void Write(std::span<const uint16_t> code, Format format, char* out, size_t jobs);
+}
\ No newline at end of file
@@ -2,18 +2,25 @@
 
 #include "Lexer.h"
 #include "SemanticToken.h"
-#include "IO/Log.h"
+#include "InlineStack.h"
+#include "CanonicalInstructions.h"
+#include "Scan.h"
+#include "Trace.h"
+#include "IO/Diagnostics.h"
 
 #include <expected>
-#include <istream>
 #include <numeric>
+#include <algorithm>
+#include <thread>
+#include <latch>
+#include <memory>
 
 class DebugState {
 public:
-    Log::StreamState StreamInfo;
-    std::vector<Lexer::Token> TokenStack;
+    IO::Diagnostics::StreamState StreamInfo;
+    Parser::ExpressionStack<Lexer::Token> TokenStack;
 
-    DebugState(std::istream& stream) : StreamInfo(stream) {}
+    DebugState(std::string_view source) : StreamInfo(source) {}
 
     void ResetExpression() {
         StreamInfo.ExpressionOffset = StreamInfo.TokenOffset = (size_t)-1;
@@ -21,12 +28,6 @@ public:
         TokenStack.clear();
     }
 
-    void AddLine() {
-        ResetExpression();
-        StreamInfo.LineLength = 0;
-        StreamInfo.LineNumber++;
-    }
-
     void ExpressionAdd(const Lexer::Token& token) {
         TokenStack.push_back(token);
         if (StreamInfo.ExpressionOffset != (size_t)-1) {
@@ -37,29 +38,70 @@ public:
         StreamInfo.ExpressionOffset += StreamInfo.LineLength - token.Data.length() + 1;
         StreamInfo.ExpressionLength += token.Data.length();
     }
-};
 
-static constexpr bool CollapseStack(std::vector<SemanticToken>& semanticStack, std::vector<std::variant<AddressingInstruction, ComputeInstruction>>& instructions, DebugState& debug) {
-    if (semanticStack.empty()) return false;
+    // Re-lexes the line up to position, which must be the end of the token being processed, 
+    // and rebuilds the state of the line and of the expression that token ends.
+    static DebugState Replay(std::string_view source, const Parser::Line& line, size_t position) {
+        DebugState debug(source);
+        debug.StreamInfo.Position = position;
+        debug.StreamInfo.LineNumber = line.Number;
+        
+        Parser::ExpressionStack<SemanticToken> semanticStack;
+        std::string_view stream = source.substr(line.Start);
+        while (source.size() - stream.size() < position) {
+            auto [token, result] = SemanticToken::Lex(stream);
+            debug.StreamInfo.LineLength += token.CharactersConsumed;
+
+            if (source.size() - stream.size() >= position) { // The token being processed only counts towards the line
+                break;
+            }
 
+            if (token.Type == Lexer::TokenType::Label) {
+                semanticStack.clear();
+                debug.ResetExpression();
+                continue;
+            }
 
-    std::expected<std::variant<AddressingInstruction, ComputeInstruction>, Instructions::ParseError> result;
-    if (semanticStack.size() == 1) {
-        result = AddressingInstruction::Create(semanticStack.front());
-    }
-    else {
-        result = ComputeInstruction::Create(semanticStack);
+            if (!result.has_value()) {
+                continue;
+            }
+
+            bool hasWhiteSpace = token.CharactersConsumed != token.Data.length();
+            if (!semanticStack.empty() && hasWhiteSpace && !result.value().ValidAfter(semanticStack.back())) {
+                semanticStack.clear();
+                debug.ResetExpression();
+            }
+
+            semanticStack.push_back(result.value());
+            debug.ExpressionAdd(token);
+        }
+
+        return debug;
     }
+};
+
+static void LabelRedefined(std::string_view source, IO::Diagnostics& diagnostics, const Parser::Line& line, size_t position, size_t length) {
+    const IO::Diagnostics::StreamState info = DebugState::Replay(source, line, position).StreamInfo;
+    diagnostics.Error("Label has already been defined", info.LineLength, IO::Diagnostics::StreamState{ source, position, info.LineNumber, info.LineLength, info.LineLength - length - 1, length });
+}
 
-    semanticStack.clear();
+bool Parser::Context::CollapseStack(size_t position) {
+    if (m_SemanticStack.empty()) return false;
 
-    if (result.has_value()) {
-        instructions.emplace_back(result.value());
-        debug.ResetExpression();
+    Program& instructions = m_Result.Instructions;
+    SymbolMap& symbols = m_Result.Symbols;
+    std::expected<void, Instructions::ParseError> result = m_SemanticStack.size() == 1
+        ? AddressingInstruction::Create(m_SemanticStack.front(), symbols).transform([&](const AddressingInstruction& instruction) { instructions.Add(instruction, symbols); })
+        : ComputeInstruction::Create(m_SemanticStack).transform([&](const ComputeInstruction& instruction) { instructions.Add(instruction); });
+
+    m_SemanticStack.clear();
 
+    if (result.has_value()) {
         return false;
     }
 
+    DebugState debug = DebugState::Replay(m_Source, m_Line, position);
+
     const auto& error = result.error();
     if (error.StackIndex < debug.TokenStack.size()) {
         debug.StreamInfo.TokenLength = debug.TokenStack.front().Data.length();
@@ -73,105 +115,235 @@ static constexpr bool CollapseStack(std::vector<SemanticToken>& semanticStack, s
         }
     }
 
-    Log::Error(error, debug.StreamInfo);
-    debug.ResetExpression();
+    m_Diagnostics.Error(error, debug.StreamInfo);
     return true;
 };
 
-std::optional<Parser::ParseResult> Parser::Parse(std::istream& stream) {
-    std::vector<std::variant<AddressingInstruction, ComputeInstruction>> instructions;
-    SymbolMap symbols;
+bool Parser::Context::Consume(const SemanticToken::Lexed& lexed, size_t position) {
+    const auto& [token, result] = lexed;
 
-    std::vector<SemanticToken> semanticStack;
-    bool errors = false;
+    switch (token.Type) {
+        using enum Lexer::TokenType::Value;
+    case EndOfStream:
+        m_Errors |= CollapseStack(position);
+        return false;
+    case Comment:
+        return true;
+    case Label: {
+        m_Errors |= CollapseStack(position);
+
+        if (result.has_value() && result.value().GetType() == SemanticToken::Type::Variable) {
+            if (m_Chunk) {
+                m_Labels.push_back(Parser::Label{ m_Result.Symbols.Intern(token.Data), static_cast<uint32_t>(m_Result.Instructions.Size()), position, m_Line });
+                return true;
+            }
+
+            if (m_Result.Symbols.TryAddLabel(token.Data, static_cast<uint16_t>(m_Result.Instructions.Size()))) {
+                return true;
+            }
+            
+            LabelRedefined(m_Source, m_Diagnostics, m_Line, position, token.Data.length());
+            m_Errors = true;
+            return true;
+        } 
+
+        // Measured from the label itself, which may not be closed
+        const IO::Diagnostics::StreamState info = DebugState::Replay(m_Source, m_Line, position).StreamInfo;
+        const size_t offset = static_cast<size_t>(token.Data.data() - m_Source.data()) - (position - info.LineLength);
+        m_Diagnostics.Error(result.has_value() ? SemanticToken::ParseError::InvalidTokenData : result.error(), Lexer::TokenType::Label, IO::Diagnostics::StreamState{ m_Source, position, info.LineNumber, info.LineLength, offset, token.Data.length() });
+        m_Errors = true;
+        return true;
+    }
+    case Newline:
+        m_Errors |= CollapseStack(position);
+        m_Line.Start = position;
+        m_Line.Number++;
+        return true;
+    default: 
+        break;
+    }
 
-    DebugState debug(stream);
-    for (bool done = false; !done;) {
-        std::expected<SemanticToken, SemanticToken::ParseError> result(std::unexpect, SemanticToken::ParseError::Unexpected);
-        Lexer::Token token = Lexer::GetNextToken(stream);
+    if (!result.has_value()) {
+        const IO::Diagnostics::StreamState info = DebugState::Replay(m_Source, m_Line, position).StreamInfo;
+        size_t offset = info.LineLength - token.Data.length();
+        m_Diagnostics.Error(result.error(), token.Type, IO::Diagnostics::StreamState{m_Source, position, info.LineNumber, info.LineLength, offset, token.Data.length()});
+        m_Errors = true;
+        return true;
+    }
 
-        debug.StreamInfo.LineLength += token.CharactersConsumed;
-        
-        switch (token.Type) {
-            using enum Lexer::TokenType::Value;
-        case EndOfStream:
-            errors |= CollapseStack(semanticStack, instructions, debug);
-            done = true;
-            continue;
-        case Comment:
-            continue;
-        case Label:
-            errors |= CollapseStack(semanticStack, instructions, debug);
-
-            token.Type = Lexer::TokenType::String;
-            result = SemanticToken::Create(token);
-            if (result.has_value() && result.value().GetType() == SemanticToken::Type::Variable) {
-                if (symbols.TryAddLabel(token.Data, static_cast<uint16_t>(instructions.size()))) {
-                    continue;
+    bool hasWhiteSpace = token.CharactersConsumed != token.Data.length();
+    if (!m_SemanticStack.empty() && hasWhiteSpace && !result.value().ValidAfter(m_SemanticStack.back())) {
+        m_Errors |= CollapseStack(position);
+    }
+
+    m_SemanticStack.push_back(result.value());
+    return true;
+}
+
+std::optional<Parser::ParseResult> Parser::Context::Finish() && {
+    return m_Errors ? std::optional<ParseResult>(std::nullopt) : std::optional<ParseResult>(std::move(m_Result));
+}
+
+Parser::Chunk Parser::Context::FinishChunk() && {
+    return Chunk{ std::move(m_Result.Instructions), std::move(m_Result.Symbols), std::move(m_Labels), m_Errors };
+}
+
+// Below this much input per thread, starting threads and merging chunks costs more than it saves
+static constexpr size_t MinimumChunkSize = 1 << 20;
+
+struct ParseCounters {
+    size_t Tokens = 0;
+    size_t CanonicalInstructions = 0;
+};
+
+// Only the instantiation with Count touches counters, the other is the plain parsing loop
+template <bool Count>
+static void ParseRange(Parser::Context& context, std::string_view source, size_t start, size_t end, [[maybe_unused]] ParseCounters* counters) {
+    std::string_view stream = source.substr(start, end - start);
+    for (bool more = true; more;) {
+        if (context.ExpressionEmpty()) {
+            if (auto canonical = CanonicalInstructions::TryMatch(stream)) {
+                if constexpr (Count) {
+                    counters->CanonicalInstructions++;
                 }
-                
-                Log::ErrorHeader(debug.StreamInfo.LineNumber, debug.StreamInfo.LineLength);
-                Log::Message("Label has already been defined");
-                Log::ErrorLine(Log::StreamState{ stream, debug.StreamInfo.LineNumber, debug.StreamInfo.LineLength, debug.StreamInfo.LineLength - token.Data.length() - 1, token.Data.length() });
 
-                errors = true;
+                context.Add(canonical->Code);
+                stream.remove_prefix(canonical->Length);
                 continue;
-            } 
-
-            Log::Error(result.error(), Lexer::TokenType::Label, Log::StreamState{ stream, debug.StreamInfo.LineNumber, debug.StreamInfo.LineLength, debug.StreamInfo.LineLength - token.Data.length() - 1, token.Data.length() });
-            continue;
-        case Newline:
-            debug.StreamInfo.LineLength++;
-            errors |= CollapseStack(semanticStack, instructions, debug);
-            debug.AddLine();
-            continue;
-	    default: 
-            break;
+            }
         }
 
-        result = SemanticToken::Create(token);
-        if (!result.has_value()) {
-            size_t offset = debug.StreamInfo.LineLength - token.Data.length();
-            Log::Error(result.error(), token.Type, Log::StreamState{stream, debug.StreamInfo.LineNumber, debug.StreamInfo.LineLength, offset, token.Data.length()});
-            continue;
+        SemanticToken::Lexed lexed = SemanticToken::Lex(stream);
+        if constexpr (Count) {
+            counters->Tokens += lexed.Token.Type != Lexer::TokenType::EndOfStream;
         }
 
-        bool hasWhiteSpace = token.CharactersConsumed != token.Data.length();
-        if (!semanticStack.empty() && hasWhiteSpace && !result.value().ValidAfter(semanticStack.back())) {
-            errors |= CollapseStack(semanticStack, instructions, debug);
+        more = context.Consume(lexed, end - stream.size());
+    }
+}
+
+static void ParseRange(Parser::Context& context, std::string_view source, size_t start, size_t end, ParseCounters* counters) {
+    counters ? ParseRange<true>(context, source, start, end, counters) : ParseRange<false>(context, source, start, end, nullptr);
+}
+
+// Parses every chunk on its own thread with its own symbols and diagnostics, then links them up in order: 
+// labels are offset by the instruction count of the chunks before them and fixups are renumbered, 
+// so variables are still allocated in order of first use when the program is linked.
+// Chunks are allocated from arenas of their own, memory resources are not safe to share between threads
+static std::optional<Parser::ParseResult> ParseChunks(std::string_view source, IO::Diagnostics& diagnostics, size_t chunkCount, std::pmr::memory_resource* resource, Statistics* statistics) {
+    std::vector<size_t> bounds = { 0 };
+    for (size_t i = 1; i < chunkCount; i++) {
+        size_t bound = Scan::FindNewline(source, std::max(bounds.back(), source.size() / chunkCount * i)) + 1;
+        if (bound >= source.size()) {
+            break;
         }
 
-        semanticStack.emplace_back(result.value());
-        debug.ExpressionAdd(token);
+        bounds.push_back(bound);
     }
 
-    return errors ? std::optional<ParseResult>(std::nullopt) : std::optional<ParseResult>(std::in_place, instructions, symbols);
-}
+    bounds.push_back(source.size());
+    chunkCount = bounds.size() - 1;
+
+    std::vector<size_t> lineCounts(chunkCount);
+    std::vector<IO::Diagnostics> chunkDiagnostics(chunkCount, diagnostics.Child());
+    auto arenas = std::make_unique<std::pmr::monotonic_buffer_resource[]>(chunkCount);
+    std::vector<std::optional<Parser::Chunk>> chunks(chunkCount);
+    std::vector<ParseCounters> counters(chunkCount);
+    std::latch counted(static_cast<std::ptrdiff_t>(chunkCount));
+
+    auto parseChunk = [&](size_t i) {
+        Trace::Zone zone("parse chunk");
+        std::string_view text = source.substr(bounds[i], bounds[i + 1] - bounds[i]);
+        lineCounts[i] = std::count(text.begin(), text.end(), '\n');
+        counted.arrive_and_wait();
+
+        Parser::Line line{ bounds[i], std::accumulate(lineCounts.begin(), lineCounts.begin() + i, (size_t)1) };
+        Parser::Context context(source, chunkDiagnostics[i], line, &arenas[i]);
+        ParseRange(context, source, bounds[i], bounds[i + 1], statistics ? &counters[i] : nullptr);
+        chunks[i] = std::move(context).FinishChunk();
+    };
+
+    {
+        PhaseTimer timer(statistics, "parse chunks");
+        std::vector<std::jthread> workers;
+        for (size_t i = 1; i < chunkCount; i++) {
+            workers.emplace_back(parseChunk, i);
+        }
 
-std::vector<std::variant<LoadInstruction, ComputeInstruction>> Parser::ParseResult::ResolveSymbols(ParseResult& parsed) {
-     auto transform = [&parsed](const auto& instruction) {
-        if constexpr (std::is_convertible_v<ComputeInstruction, decltype(instruction)>) {
-            return std::variant<LoadInstruction, ComputeInstruction>(instruction);
-        } else {
-            auto variable = std::get_if<std::string>(&instruction.Variable);
+        parseChunk(0);
+    }
 
-            if (!variable) {
-                return std::variant<LoadInstruction, ComputeInstruction>(LoadInstruction{ std::get<uint16_t>(instruction.Variable) });
+    if (statistics) {
+        statistics->Chunks = chunkCount;
+        for (const ParseCounters& chunkCounters : counters) {
+            statistics->Tokens += chunkCounters.Tokens;
+            statistics->CanonicalInstructions += chunkCounters.CanonicalInstructions;
+        }
+    }
+
+    PhaseTimer timer(statistics, "merge chunks");
+    Trace::Zone zone("merge chunks");
+    Parser::ParseResult result(resource);
+    bool errors = false;
+    std::vector<SymbolId> symbols;
+    for (size_t i = 0; i < chunkCount; i++) {
+        Parser::Chunk& chunk = chunks[i].value();
+        const size_t address = result.Instructions.Size();
+
+        symbols.clear();
+        for (uint32_t symbol = 0; symbol < chunk.Symbols.Size(); symbol++) {
+            symbols.push_back(result.Symbols.Intern(chunk.Symbols.GetName(SymbolId{ symbol })));
+        }
+
+        // Redefinitions are only found here, also within one chunk, and are merged with the other diagnostics of the chunk by position
+        IO::Diagnostics labelDiagnostics = diagnostics.Child();
+        for (const Parser::Label& label : chunk.Labels) {
+            std::string_view name = chunk.Symbols.GetName(label.Symbol);
+            if (!result.Symbols.TryAddLabel(name, static_cast<uint16_t>(address + label.Address))) {
+                LabelRedefined(source, labelDiagnostics, label.SourceLine, label.Position, name.length());
             }
+        }
 
-            uint16_t value = parsed.Symbols.TryGet(*variable)
-                .or_else([&] { return std::optional<uint16_t>(parsed.Symbols.AddVariable(*variable)); })
-                .value();
+        result.Instructions.Append(chunk.Instructions, symbols);
+        diagnostics.Append(chunkDiagnostics[i], labelDiagnostics);
+        errors |= chunk.Errors || labelDiagnostics.ErrorCount() != 0;
+    }
 
-            return std::variant<LoadInstruction, ComputeInstruction>(LoadInstruction{ value });
-        }};
+    return errors ? std::optional<Parser::ParseResult>(std::nullopt) : std::optional<Parser::ParseResult>(std::move(result));
+}
+
+std::optional<Parser::ParseResult> Parser::Parse(std::string_view source, IO::Diagnostics& diagnostics, size_t jobs, std::pmr::memory_resource* resource, Statistics* statistics) {
+    jobs = jobs != 0 ? jobs : std::max(std::thread::hardware_concurrency(), 1u);
+    Trace::Zone zone("parse");
 
-    std::vector<std::variant<LoadInstruction, ComputeInstruction>> result;
-    result.reserve(parsed.Instructions.size());
+    std::optional<ParseResult> result;
+    size_t chunkCount = std::min(jobs, source.size() / MinimumChunkSize);
+    if (chunkCount > 1) {
+        result = ParseChunks(source, diagnostics, chunkCount, resource, statistics);
+    }
+    else {
+        PhaseTimer timer(statistics, "parse");
+        ParseCounters counters;
+        Context context(source, diagnostics, resource);
+        ParseRange(context, source, 0, source.size(), statistics ? &counters : nullptr);
+        result = std::move(context).Finish();
+
+        if (statistics) {
+            statistics->Chunks = 1;
+            statistics->Tokens += counters.Tokens;
+            statistics->CanonicalInstructions += counters.CanonicalInstructions;
+        }
+    }
 
-    for (const auto& instruction : parsed.Instructions) {
-        result.emplace_back(std::visit(transform, instruction));
+    if (statistics) {
+        statistics->Bytes = source.size();
+        statistics->Lines = std::count(source.begin(), source.end(), '\n') + (!source.empty() && !source.ends_with('\n'));
+        if (result.has_value()) {
+            statistics->Instructions = result.value().Instructions.Size();
+            statistics->Symbols = result.value().Symbols.Size() - Language::PredefinedSymbols.size();
+            statistics->SymbolSlots = result.value().Symbols.Capacity();
+        }
     }
 
     return result;
-}
+}
\ No newline at end of file
@@ -1,19 +1,93 @@
 #pragma once
 
-#include "Instructions.h"
+#include "Program.h"
 #include "SymbolMap.h"
+#include "SemanticToken.h"
+#include "InlineStack.h"
+#include "Statistics.h"
+
+#include "IO/Diagnostics.h"
 
 #include <vector>
 #include <optional>
+#include <memory_resource>
+#include <string_view>
+#include <cstdint>
 
 namespace Parser {
     class ParseResult {
     public:
-        std::vector<std::variant<AddressingInstruction, ComputeInstruction>> Instructions;
+        explicit ParseResult(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : Instructions(resource), Symbols(resource) {}
+
+        Program Instructions;
+        SymbolMap Symbols;
+    };
+
+    // One slot more than a valid instruction can use, so that longer expressions are still rejected by their length
+    template <typename T>
+    using ExpressionStack = InlineStack<T, ComputeInstruction::MaxTokens + 1>;
+
+    // The only bookkeeping done while parsing. Everything else needed for a diagnostic is rebuilt by replaying the line
+    struct Line {
+        size_t Start = 0;
+        size_t Number = 1;
+    };
+
+    // A label defined in a chunk of a source parsed in parallel, added to the symbol map once the address of the chunk is known
+    struct Label {
+        SymbolId Symbol;
+        uint32_t Address;
+        size_t Position;
+        Line SourceLine;
+    };
+
+    // One newline-aligned part of a source. Symbols are only interned, so every load of a symbol that 
+    // is not predefined is left as a fixup, and label addresses are relative to the start of the chunk
+    struct Chunk {
+        Program Instructions;
         SymbolMap Symbols;
+        std::pmr::vector<Label> Labels;
+        bool Errors;
+    };
+
+    // Parser state for one source, fed one lexed token at a time. 
+    // Parse drives it straight from the lexer, the pipeline from a queue filled by another thread
+    class Context {
+    public:
+        // Everything the result holds is allocated from resource
+        Context(std::string_view source, IO::Diagnostics& diagnostics, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) 
+            : m_Source(source), m_Diagnostics(diagnostics), m_Result(resource), m_Labels(resource) {}
+        // Parses the chunk of source that starts at line, see Chunk
+        Context(std::string_view source, IO::Diagnostics& diagnostics, Line line, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) 
+            : m_Source(source), m_Diagnostics(diagnostics), m_Result(resource), m_Line(line), m_Chunk(true), m_Labels(resource) {}
+
+        // position is the offset in source just past the token. Returns false once the end of the stream has been consumed
+        bool Consume(const SemanticToken::Lexed& lexed, size_t position);
+        // Adds an instruction that was already encoded, i.e. by CanonicalInstructions
+        inline void Add(uint16_t code) { m_Result.Instructions.Add(code); }
+
+        inline bool ExpressionEmpty() const { return m_SemanticStack.empty(); }
+        inline const Program& Instructions() const { return m_Result.Instructions; }
+
+        std::optional<ParseResult> Finish() &&;
+        Chunk FinishChunk() &&;
+    private:
+        bool CollapseStack(size_t position);
+
+        std::string_view m_Source;
+        IO::Diagnostics& m_Diagnostics;
+
+        ParseResult m_Result;
+        ExpressionStack<SemanticToken> m_SemanticStack;
+        Line m_Line;
+        bool m_Errors = false;
 
-        static std::vector<std::variant<LoadInstruction, ComputeInstruction>> ResolveSymbols(ParseResult& parsed);
+        bool m_Chunk = false;
+        std::pmr::vector<Label> m_Labels;
     };
 
-    std::optional<ParseResult> Parse(std::istream& stream);
+    // Sources of a few megabytes or more are split at line boundaries and parsed on up to jobs threads, 0 meaning one per core.
+    // The result and the order of the diagnostics do not depend on the number of jobs. The result is allocated from resource.
+    // Statistics, if given, get the parse phases and the counters of the source
+    std::optional<ParseResult> Parse(std::string_view source, IO::Diagnostics& diagnostics, size_t jobs = 1, std::pmr::memory_resource* resource = std::pmr::get_default_resource(), Statistics* statistics = nullptr);
 };
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include "Pipeline.h"
+
+#include "Parser.h"
+#include "CodeGeneration.h"
+#include "SemanticToken.h"
+#include "CanonicalInstructions.h"
+#include "SpscQueue.h"
+#include "Trace.h"
+
+#include <thread>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <algorithm>
+#include <functional>
+
+using HackText::LineWidth;
+
+struct LexedItem {
+    // Empty when the lexer matched a canonical instruction instead, encoded in Code
+    std::optional<SemanticToken::Lexed> Lexed;
+    size_t Position;
+    uint16_t Code;
+};
+
+struct TokenBatch {
+    std::array<LexedItem, 512> Items;
+    size_t Count;
+};
+
+struct WordBatch {
+    std::array<uint16_t, 4096> Words;
+    size_t Count;
+    bool Last;
+};
+
+struct TextBatch {
+    std::array<char, std::tuple_size_v<decltype(WordBatch::Words)> * LineWidth> Text;
+    size_t Length;
+    bool Last;
+};
+
+using TokenQueue = SpscQueue<TokenBatch, 16>;
+using WordQueue = SpscQueue<WordBatch, 16>;
+using TextQueue = SpscQueue<TextBatch, 16>;
+
+// Canonical instructions are only tried at the start of a line, where the parser's expression is always empty
+static void LexStage(std::string_view source, TokenQueue& tokens) {
+    Trace::Zone zone("lex");
+    std::string_view stream = source;
+    bool lineStart = true;
+
+    for (bool more = true; more;) {
+        TokenBatch& batch = tokens.BeginPush();
+        batch.Count = 0;
+
+        while (more && batch.Count < batch.Items.size()) {
+            LexedItem& item = batch.Items[batch.Count++];
+
+            if (lineStart) {
+                lineStart = false;
+                if (auto canonical = CanonicalInstructions::TryMatch(stream)) {
+                    stream.remove_prefix(canonical->Length);
+                    item.Lexed.reset();
+                    item.Code = canonical->Code;
+                    continue;
+                }
+            }
+
+            item.Lexed = SemanticToken::Lex(stream);
+            item.Position = source.size() - stream.size();
+
+            lineStart = item.Lexed->Token.Type == Lexer::TokenType::Newline;
+            more = item.Lexed->Token.Type != Lexer::TokenType::EndOfStream;
+        }
+
+        tokens.EndPush();
+    }
+}
+
+static void PushWords(std::span<const uint16_t> code, size_t& forwarded, WordQueue& words, bool last) {
+    do {
+        WordBatch& batch = words.BeginPush();
+        batch.Count = std::min(code.size() - forwarded, batch.Words.size());
+        std::copy_n(code.begin() + forwarded, batch.Count, batch.Words.begin());
+        forwarded += batch.Count;
+        batch.Last = last && forwarded == code.size();
+        words.EndPush();
+    } while (forwarded != code.size());
+}
+
+static std::optional<Parser::ParseResult> ParseStage(std::string_view source, IO::Diagnostics& diagnostics, TokenQueue& tokens, WordQueue& words) {
+    Trace::Zone zone("parse");
+    Parser::Context context(source, diagnostics);
+    size_t forwarded = 0;
+
+    for (bool more = true; more;) {
+        const TokenBatch& batch = tokens.BeginPop();
+        for (size_t i = 0; more && i < batch.Count; i++) {
+            const LexedItem& item = batch.Items[i];
+            if (!item.Lexed.has_value()) {
+                context.Add(item.Code);
+                continue;
+            }
+
+            more = context.Consume(item.Lexed.value(), item.Position);
+        }
+        tokens.EndPop();
+
+        std::span<const uint16_t> code = context.Instructions().Code();
+        if (!more || code.size() - forwarded >= std::tuple_size_v<decltype(WordBatch::Words)>) {
+            PushWords(code, forwarded, words, !more);
+        }
+    }
+
+    return std::move(context).Finish();
+}
+
+static void FormatStage(WordQueue& words, TextQueue& text) {
+    Trace::Zone zone("format text");
+    for (bool last = false; !last;) {
+        const WordBatch& input = words.BeginPop();
+        TextBatch& output = text.BeginPush();
+
+        HackText::Encode(std::span(input.Words).first(input.Count), output.Text.data());
+        output.Length = input.Count * LineWidth;
+        output.Last = last = input.Last;
+
+        text.EndPush();
+        words.EndPop();
+    }
+}
+
+static void WriteStage(TextQueue& text, std::ostream& output) {
+    Trace::Zone zone("write");
+    for (bool last = false; !last;) {
+        const TextBatch& batch = text.BeginPop();
+        output.write(batch.Text.data(), static_cast<std::streamsize>(batch.Length));
+        last = batch.Last;
+        text.EndPop();
+    }
+}
+
+template <typename Queue>
+static Pipeline::QueueStatistics GetStatistics(std::string_view name, const Queue& queue) {
+    auto statistics = queue.GetStatistics();
+    return Pipeline::QueueStatistics{ name, queue.GetCapacity(), statistics.Pushes, statistics.AverageOccupancy(), statistics.FullWaits, statistics.EmptyWaits };
+}
+
+Pipeline::Result Pipeline::Assemble(std::string_view source, IO::Diagnostics& diagnostics, std::ostream& output) {
+    auto tokens = std::make_unique<TokenQueue>();
+    auto words = std::make_unique<WordQueue>();
+    auto text = std::make_unique<TextQueue>();
+
+    std::optional<Parser::ParseResult> parsed;
+    {
+        std::jthread lexer(LexStage, source, std::ref(*tokens));
+        std::jthread parser([&] { parsed = ParseStage(source, diagnostics, *tokens, *words); });
+        std::jthread formatter(FormatStage, std::ref(*words), std::ref(*text));
+        WriteStage(*text, output);
+    }
+
+    Result result{ parsed.has_value(), {
+        GetStatistics("lex -> parse", *tokens),
+        GetStatistics("parse -> format", *words),
+        GetStatistics("format -> write", *text),
+    }};
+
+    if (!parsed.has_value()) {
+        return result;
+    }
+
+    // Everything is written, the symbols left undefined get their lines rewritten
+    std::vector<Program::Fixup> fixups(parsed->Instructions.Fixups().begin(), parsed->Instructions.Fixups().end());
+    std::vector<uint16_t> code = std::move(parsed->Instructions).Link(parsed->Symbols);
+
+    Trace::Zone zone("patch fixups");
+    std::array<char, LineWidth> line;
+    for (const Program::Fixup& fixup : fixups) {
+        HackText::Encode(std::span(code).subspan(fixup.Index, 1), line.data());
+        output.seekp(static_cast<std::streamoff>(fixup.Index * LineWidth));
+        output.write(line.data(), 16);
+    }
+
+    output.seekp(0, std::ios::end);
+    output.flush();
+    result.Success = output.good();
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "IO/Diagnostics.h"
+
+#include <array>
+#include <string_view>
+#include <ostream>
+
+// Assembles with lexing, parsing, formatting and writing each on their own thread, connected by
+// bounded SPSC queues of fixed-size batches. Output is written while the source is still being lexed,
+// with placeholder lines for symbols that are not defined yet, which are patched in place at the end.
+namespace Pipeline {
+    struct QueueStatistics {
+        std::string_view Name;
+        size_t Capacity;
+        size_t Batches;
+        double AverageOccupancy;
+        size_t FullWaits;
+        size_t EmptyWaits;
+    };
+
+    struct Result {
+        bool Success;
+        std::array<QueueStatistics, 3> Queues;
+    };
+
+    // output must be a seekable binary stream, it has unspecified contents if assembly fails
+    Result Assemble(std::string_view source, IO::Diagnostics& diagnostics, std::ostream& output);
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "Program.h"
+
+#include "CodeGeneration.h"
+#include "Trace.h"
+
+void Program::Add(uint16_t code) {
+    m_Code.push_back(code);
+}
+
+void Program::Add(const AddressingInstruction& instruction, const SymbolMap& symbols) {
+    const SymbolId* symbol = std::get_if<SymbolId>(&instruction.Variable);
+    if (!symbol) {
+        m_Code.push_back(std::get<uint16_t>(instruction.Variable));
+        return;
+    }
+
+    if (auto value = symbols.TryGet(*symbol)) {
+        m_Code.push_back(value.value());
+        return;
+    }
+
+    m_Fixups.push_back(Fixup{ static_cast<uint32_t>(m_Code.size()), *symbol });
+    m_Code.push_back(0);
+}
+
+void Program::Add(const ComputeInstruction& instruction) {
+    m_Code.push_back(CodeGeneration::Encode(instruction));
+}
+
+void Program::Append(const Program& program, std::span<const SymbolId> symbols) {
+    const uint32_t offset = static_cast<uint32_t>(m_Code.size());
+    m_Code.insert(m_Code.end(), program.m_Code.begin(), program.m_Code.end());
+
+    m_Fixups.reserve(m_Fixups.size() + program.m_Fixups.size());
+    for (const Fixup& fixup : program.m_Fixups) {
+        m_Fixups.push_back(Fixup{ offset + fixup.Index, symbols[fixup.Symbol.Index] });
+    }
+}
+
+std::vector<uint16_t> Program::Link(SymbolMap& symbols) && {
+    Trace::Zone zone("resolve symbols");
+    for (const Fixup& fixup : m_Fixups) {
+        m_Code[fixup.Index] = symbols.AddVariable(fixup.Symbol);
+    }
+
+    m_Fixups.clear();
+    return std::vector<uint16_t>(m_Code.begin(), m_Code.end());
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Instructions.h"
+#include "SymbolMap.h"
+
+#include <vector>
+#include <span>
+#include <memory_resource>
+#include <cstdint>
+
+// Machine code, emitted as instructions are parsed. Loads of symbols that are not defined yet 
+// (forward references to labels and variables) get a placeholder word and a fixup, patched by Link
+class Program {
+public:
+    struct Fixup {
+        uint32_t Index;
+        SymbolId Symbol;
+    };
+
+    explicit Program(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : m_Code(resource), m_Fixups(resource) {}
+
+    void Add(uint16_t code);
+    void Add(const AddressingInstruction& instruction, const SymbolMap& symbols);
+    void Add(const ComputeInstruction& instruction);
+    // Appends the code of a program parsed with its own symbol map. symbols maps its symbol IDs to the ones of this program
+    void Append(const Program& program, std::span<const SymbolId> symbols);
+
+    inline size_t Size() const { return m_Code.size(); }
+    // Words of unresolved symbols are zero until Link
+    inline std::span<const uint16_t> Code() const { return m_Code; }
+    inline std::span<const Fixup> Fixups() const { return m_Fixups; }
+
+    // Fixups are patched in order of appearance, so symbols that are still undefined 
+    // get variable addresses in order of first use. The code is copied out of the memory resource of the program
+    std::vector<uint16_t> Link(SymbolMap& symbols) &&;
+private:
+    std::pmr::vector<uint16_t> m_Code;
+    std::pmr::vector<Fixup> m_Fixups;
+};
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #define SCAN_SSE2
+    #include <emmintrin.h>
+#endif
+
+// Character classes of the lexer and scanning over runs of them.
+// Only the search for the end of a comment is vectorized, with SSE2 which is always available on x64. Symbols, integers and
+// whitespace nearly always end within a few characters, where the vector loads measured slower than the scalar loops.
+// Tails shorter than one vector are finished with the scalar predicates.
+namespace Scan {
+    constexpr bool IsNumeric(char character) {
+        return '0' <= character && character <= '9';
+    }
+
+    constexpr bool IsAlpha(char character) {
+        character &= ~32;
+        return 'A' <= character && character <= 'Z';
+    }
+
+    constexpr bool IsSpecial(char character) {
+        return  character == '_' || character == '.' || character == '$' || character == ':';
+    }
+
+    constexpr bool IsSymbol(char character) {
+        return IsNumeric(character) || IsAlpha(character) || IsSpecial(character);
+    }
+
+    constexpr bool IsOperation(char character) {
+        return character == '=' || character == ';' || character == '!' || character == '+' || character == '-' || character == '&' || character == '|';
+    }
+
+    constexpr bool IsWhitespace(char character) {
+        return character == ' ' || character == '\t' || character == '\r';
+    }
+
+    constexpr bool IsNotNewline(char character) {
+        return character != '\n';
+    }
+
+    namespace Detail {
+        // Returns the index of the first character at or after position that is not in the class
+        template <bool(*InClass)(char)>
+        inline size_t SkipScalar(std::string_view text, size_t position) {
+            while (position < text.size() && InClass(text[position])) {
+                position++;
+            }
+
+            return position;
+        }
+
+#ifdef SCAN_SSE2
+        using Vector = __m128i;
+        inline Vector Load(const char* data) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)); }
+        inline Vector Splat(char character) { return _mm_set1_epi8(character); }
+        inline Vector Equal(Vector a, Vector b) { return _mm_cmpeq_epi8(a, b); }
+        inline uint32_t Mask(Vector a) { return static_cast<uint32_t>(_mm_movemask_epi8(a)); }
+
+        constexpr size_t Width = sizeof(Vector);
+        constexpr uint32_t FullMask = static_cast<uint32_t>((uint64_t(1) << Width) - 1);
+
+        inline Vector NotNewline(Vector block) {
+            return Equal(Equal(block, Splat('\n')), Splat(0));
+        }
+
+        template <bool(*InClass)(char), Vector(*VectorInClass)(Vector)>
+        inline size_t Skip(std::string_view text, size_t position) {
+            if (position < text.size() && !InClass(text[position])) {
+                return position;
+            }
+
+            for (; position + Width <= text.size(); position += Width) {
+                uint32_t outside = ~Mask(VectorInClass(Load(text.data() + position))) & FullMask;
+                if (outside) {
+                    return position + std::countr_zero(outside);
+                }
+            }
+
+            return SkipScalar<InClass>(text, position);
+        }
+#endif
+    }
+
+    // The same scans one character at a time, what the vectorized one is measured and checked against
+    namespace Scalar {
+        inline size_t SkipWhitespace(std::string_view text, size_t position) { return Detail::SkipScalar<IsWhitespace>(text, position); }
+        inline size_t SkipInteger(std::string_view text, size_t position) { return Detail::SkipScalar<IsNumeric>(text, position); }
+        inline size_t SkipSymbol(std::string_view text, size_t position) { return Detail::SkipScalar<IsSymbol>(text, position); }
+        inline size_t FindNewline(std::string_view text, size_t position) { return Detail::SkipScalar<IsNotNewline>(text, position); }
+    }
+
+    using Scalar::SkipWhitespace;
+    using Scalar::SkipInteger;
+    using Scalar::SkipSymbol;
+
+#ifdef SCAN_SSE2
+    inline size_t FindNewline(std::string_view text, size_t position) { return Detail::Skip<IsNotNewline, Detail::NotNewline>(text, position); }
+#else
+    using Scalar::FindNewline;
+#endif
+}
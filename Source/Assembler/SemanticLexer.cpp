@@ -0,0 +1,263 @@
+#include "SemanticToken.h"
+#include "Scan.h"
+
+#include <array>
+#include <algorithm>
+#include <utility>
+
+// Table driven lexer that emits semantic tokens directly. All tables are generated at compile time 
+// from the same character classes as Lexer::GetNextToken, and symbols are classified by a DFA 
+// instead of the string searches and comparisons in SemanticToken::Create.
+
+enum class StartClass : uint8_t {
+    Skip = 0,
+    Newline,
+    Slash,
+    Operation,
+    Label,
+    Integer,
+    String,
+};
+
+static constexpr std::array<StartClass, 256> StartClasses = [] {
+    std::array<StartClass, 256> result{};
+
+    for (size_t i = 0; i < result.size(); i++) {
+        char character = static_cast<char>(i);
+
+        if (character == '\n') { result[i] = StartClass::Newline; }
+        else if (character == '/') { result[i] = StartClass::Slash; }
+        else if (Scan::IsOperation(character)) { result[i] = StartClass::Operation; }
+        else if (character == '(') { result[i] = StartClass::Label; }
+        else if (Scan::IsNumeric(character)) { result[i] = StartClass::Integer; }
+        else if (Scan::IsSymbol(character)) { result[i] = StartClass::String; }
+    }
+
+    return result;
+}();
+
+static constexpr std::array<Operations, 256> OperationTable = [] {
+    std::array<Operations, 256> result{};
+
+    result['='] = Operations::Assignment;
+    result['!'] = Operations::Negation;
+    result['+'] = Operations::Addition;
+    result['-'] = Operations::Subtraction;
+    result['&'] = Operations::BitwiseAnd;
+    result['|'] = Operations::BitwiseOr;
+    result[';'] = Operations::Jump;
+
+    return result;
+}();
+
+// Characters as seen by the symbol DFA. Letters of register and jump mnemonics get their own class,
+// the rest are split by whether they are symbol characters and whether SemanticToken::Create 
+// rejects symbols starting with them (anything up to '9', i.e. digits and ".$:")
+enum SymbolClass : uint8_t {
+    ClassA, ClassD, ClassM, ClassJ, ClassG, ClassT, ClassE, ClassQ, ClassL, ClassN, ClassP,
+    ClassSymbol, ClassLowSymbol, ClassOther, ClassLowOther,
+    SymbolClassCount,
+};
+
+static constexpr std::array<uint8_t, 256> SymbolClasses = [] {
+    std::array<uint8_t, 256> result{};
+
+    for (size_t i = 0; i < result.size(); i++) {
+        char character = static_cast<char>(i);
+        bool low = character - '0' <= 9;
+
+        result[i] = Scan::IsSymbol(character) ? (low ? ClassLowSymbol : ClassSymbol) : (low ? ClassLowOther : ClassOther);
+    }
+
+    constexpr std::string_view letters = "ADMJGTEQLNP";
+    for (size_t i = 0; i < letters.size(); i++) {
+        result[static_cast<uint8_t>(letters[i])] = static_cast<uint8_t>(ClassA + i);
+    }
+
+    return result;
+}();
+
+enum SymbolState : uint8_t {
+    Start = 0,
+    Invalid,
+    Variable,
+    Registers, // One state per non-empty register set, Registers - 1 + (A | D << 1 | M << 2)
+    J = Registers + 7,
+    JG, JE, JL, JN, JM,
+    JGT, JGE, JEQ, JLT, JLE, JNE, JMP,
+    Done,
+    SymbolStateCount,
+};
+
+static constexpr uint8_t RegisterState(uint8_t registers) {
+    return static_cast<uint8_t>(Registers - 1 + registers);
+}
+
+static constexpr auto SymbolTransitions = [] {
+    std::array<std::array<uint8_t, SymbolClassCount>, SymbolStateCount> result{};
+
+    // By default symbol characters turn any symbol into a plain variable and anything else ends it
+    for (auto& transitions : result) {
+        for (size_t c = 0; c < SymbolClassCount; c++) {
+            transitions[c] = (c == ClassOther || c == ClassLowOther) ? Done : Variable;
+        }
+    }
+
+    // The first character is taken whatever it is, because labels may start with anything
+    result[Start][ClassLowSymbol] = Invalid;
+    result[Start][ClassLowOther] = Invalid;
+    result[Start][ClassOther] = Variable;
+    result[Start][ClassJ] = J;
+    
+    for (size_t c = 0; c < ClassOther; c++) {
+        result[Invalid][c] = Invalid;
+    }
+
+    // Each register may appear once, in any order
+    constexpr uint8_t registerClasses[] = { ClassA, ClassD, ClassM };
+    for (uint8_t registers = 0; registers < 8; registers++) {
+        uint8_t state = registers == 0 ? static_cast<uint8_t>(Start) : RegisterState(registers);
+
+        for (uint8_t r = 0; r < 3; r++) {
+            uint8_t bit = static_cast<uint8_t>(1 << r);
+            result[state][registerClasses[r]] = (registers & bit) ? static_cast<uint8_t>(Variable) : RegisterState(registers | bit);
+        }
+    }
+
+    result[J][ClassG] = JG;
+    result[J][ClassE] = JE;
+    result[J][ClassL] = JL;
+    result[J][ClassN] = JN;
+    result[J][ClassM] = JM;
+
+    result[JG][ClassT] = JGT;
+    result[JG][ClassE] = JGE;
+    result[JE][ClassQ] = JEQ;
+    result[JL][ClassT] = JLT;
+    result[JL][ClassE] = JLE;
+    result[JN][ClassE] = JNE;
+    result[JM][ClassP] = JMP;
+
+    return result;
+}();
+
+static constexpr std::array<Jumps, SymbolStateCount> JumpStates = [] {
+    std::array<Jumps, SymbolStateCount> result{};
+
+    result[JGT] = Jumps::JGT;
+    result[JGE] = Jumps::JGE;
+    result[JEQ] = Jumps::JEQ;
+    result[JLT] = Jumps::JLT;
+    result[JLE] = Jumps::JLE;
+    result[JNE] = Jumps::JNE;
+    result[JMP] = Jumps::JMP;
+
+    return result;
+}();
+
+// Runs the symbol DFA from position and returns the final state and the end of the symbol
+static std::pair<uint8_t, size_t> RunSymbol(std::string_view stream, size_t position) {
+    uint8_t state = SymbolTransitions[Start][SymbolClasses[static_cast<uint8_t>(stream[position++])]];
+
+    while (state != Variable && state != Invalid && position < stream.size()) {
+        uint8_t next = SymbolTransitions[state][SymbolClasses[static_cast<uint8_t>(stream[position])]];
+        if (next == Done) {
+            return { state, position };
+        }
+
+        state = next;
+        position++;
+    }
+
+    // Plain variables need no further classification, so the rest of the run is skipped in bulk
+    return { state, Scan::SkipSymbol(stream, position) };
+}
+
+static constexpr bool IsComment(std::string_view stream, size_t position) {
+    return position + 1 < stream.size() && stream[position + 1] == '/';
+}
+
+SemanticToken::Lexed SemanticToken::Lex(std::string_view& stream) {
+    constexpr auto invalidType = std::unexpected(ParseError::InvalidTokenType);
+
+    // Characters that can not start a token (whitespace, '@', stray punctuation) are skipped, but still consumed
+    size_t position = Scan::SkipWhitespace(stream, 0);
+    StartClass start = StartClass::Skip;
+    while (position < stream.size()) {
+        start = StartClasses[static_cast<uint8_t>(stream[position])];
+        if (start != StartClass::Skip && (start != StartClass::Slash || IsComment(stream, position))) {
+            break;
+        }
+
+        position = Scan::SkipWhitespace(stream, position + 1);
+    }
+
+    if (position == stream.size()) {
+        stream.remove_prefix(position);
+        return { { Lexer::TokenType::EndOfStream, static_cast<uint32_t>(position), {} }, invalidType };
+    }
+
+    Lexed result = { { Lexer::TokenType::Invalid, static_cast<uint32_t>(position + 1), stream.substr(position, 1) }, invalidType };
+    size_t end = position + 1;
+
+    switch (start) {
+    case StartClass::Newline:
+        result.Token.Type = Lexer::TokenType::Newline;
+        break;
+    case StartClass::Slash:
+        end = Scan::FindNewline(stream, position + 2);
+        result.Token = { Lexer::TokenType::Comment, static_cast<uint32_t>(end), stream.substr(position, end - position) };
+        break;
+    case StartClass::Operation:
+        result.Token.Type = Lexer::TokenType::Operation;
+        result.Semantic = SemanticToken(OperationTable[static_cast<uint8_t>(stream[position])]);
+        break;
+    case StartClass::Integer: {
+        uint32_t value = static_cast<uint32_t>(stream[position] - '0');
+        for (; end < stream.size() && Scan::IsNumeric(stream[end]); end++) {
+            value = std::min(value * 10 + static_cast<uint32_t>(stream[end] - '0'), 0x10000u);
+        }
+
+        result.Token = { Lexer::TokenType::Integer, static_cast<uint32_t>(end), stream.substr(position, end - position) };
+        result.Semantic = value <= 0xFFFF ? std::expected<SemanticToken, ParseError>(SemanticToken(static_cast<uint16_t>(value))) : std::unexpected(ParseError::IntegerOutOfRange);
+        break;
+    }
+    case StartClass::Label:
+    case StartClass::String: {
+        bool label = start == StartClass::Label;
+        result.Token.Type = label ? Lexer::TokenType::Label : Lexer::TokenType::String;
+        
+        if (label && (position + 1 == stream.size() || stream[position + 1] == '\n')) { // A lone ( at the end of a line is a label made of just the parenthesis
+            result.Semantic = std::unexpected(ParseError::InvalidTokenData);
+            break;
+        }
+
+        // The character after ( is part of the label whatever it is. The character ending the label is consumed with it,
+        // unless the line ends there, which leaves the newline for its own token
+        size_t symbolStart = position + label;
+        auto [state, symbolEnd] = RunSymbol(stream, symbolStart);
+        
+        end = symbolEnd + (label && symbolEnd < stream.size() && stream[symbolEnd] != '\n');
+        result.Token.CharactersConsumed = static_cast<uint32_t>(end);
+        result.Token.Data = stream.substr(symbolStart, symbolEnd - symbolStart);
+
+        if (state == Invalid) {
+            result.Semantic = std::unexpected(ParseError::InvalidTokenData);
+        } else if (state >= Registers && state < J) {
+            uint8_t registers = static_cast<uint8_t>(state - Registers + 1);
+            result.Semantic = SemanticToken(::Destination{ .A = (registers & 1) != 0, .D = (registers & 2) != 0, .M = (registers & 4) != 0 });
+        } else if (JumpStates[state] != Jumps::None) {
+            result.Semantic = SemanticToken(JumpStates[state]);
+        } else {
+            result.Semantic = SemanticToken(result.Token.Data);
+        }
+        break;
+    }
+    case StartClass::Skip:
+        assert(false); // Should never reach this
+        break;
+    }
+
+    stream.remove_prefix(end);
+    return result;
+}
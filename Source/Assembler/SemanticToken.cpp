@@ -72,12 +72,12 @@ static constexpr std::optional<Jumps> TryParseJump(const std::string_view token)
     return std::nullopt;
 }
 
-static constexpr std::expected<std::string, SemanticToken::ParseError> ParseVariable(const std::string_view token) {
+static constexpr std::expected<std::string_view, SemanticToken::ParseError> ParseVariable(const std::string_view token) {
     if (token.empty()) {
         return std::unexpected(SemanticToken::ParseError::InvalidTokenData);
     }
 
-    return std::string(token);
+    return token;
 }
 
 std::expected<SemanticToken, SemanticToken::ParseError> SemanticToken::Create(const Lexer::Token& token) {
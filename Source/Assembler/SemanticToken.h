@@ -2,7 +2,7 @@
 
 #include "Lexer.h"
 
-#include <string>
+#include <string_view>
 #include <variant>
 #include <expected>
 
@@ -52,6 +52,11 @@ public:
     };
     static std::expected<SemanticToken, ParseError> Create(const Lexer::Token& token);
 
+    // Lexes the next token from stream and classifies it in the same pass. Gives the same result as 
+    // Lexer::GetNextToken followed by Create, except that labels are classified as their contents
+    struct Lexed;
+    static Lexed Lex(std::string_view& stream);
+
     bool ValidAfter(const SemanticToken& previous) const;
     inline constexpr Type GetType() const { return static_cast<Type>(m_Data.index()); };
     
@@ -66,6 +71,11 @@ public:
     }
 private:
     SemanticToken(auto data) : m_Data(data) {}
-    std::variant<Destination, uint16_t, std::string, Jumps, Operations> m_Data;
+    std::variant<Destination, uint16_t, std::string_view, Jumps, Operations> m_Data;
+};
+
+struct SemanticToken::Lexed {
+    Lexer::Token Token;
+    std::expected<SemanticToken, ParseError> Semantic;
 };
 
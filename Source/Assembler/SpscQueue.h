@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <bit>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer and one consumer thread. Elements are filled and read 
+// in place, so large batches are never copied. Both sides spin, yielding, while the queue is full or empty,
+// and count how often they had to wait.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(std::has_single_bit(Capacity));
+public:
+    struct Statistics {
+        size_t Pushes = 0;
+        size_t OccupancySum = 0;
+        size_t FullWaits = 0;
+        size_t Pops = 0;
+        size_t EmptyWaits = 0;
+
+        inline double AverageOccupancy() const { return Pushes ? static_cast<double>(OccupancySum) / static_cast<double>(Pushes) : 0.0; }
+    };
+
+    // Producer side. The returned element must be filled and then published with EndPush
+    T& BeginPush() {
+        size_t tail = m_Tail.load(std::memory_order_relaxed);
+        if (tail - m_Head.load(std::memory_order_acquire) == Capacity) {
+            m_Producer.FullWaits++;
+            while (tail - m_Head.load(std::memory_order_acquire) == Capacity) {
+                std::this_thread::yield();
+            }
+        }
+
+        return m_Elements[tail & (Capacity - 1)];
+    }
+
+    void EndPush() {
+        size_t tail = m_Tail.load(std::memory_order_relaxed) + 1;
+        m_Tail.store(tail, std::memory_order_release);
+
+        m_Producer.Pushes++;
+        m_Producer.OccupancySum += tail - m_Head.load(std::memory_order_relaxed);
+    }
+
+    // Consumer side. The returned element stays valid until EndPop
+    const T& BeginPop() {
+        size_t head = m_Head.load(std::memory_order_relaxed);
+        if (m_Tail.load(std::memory_order_acquire) == head) {
+            m_Consumer.EmptyWaits++;
+            while (m_Tail.load(std::memory_order_acquire) == head) {
+                std::this_thread::yield();
+            }
+        }
+
+        return m_Elements[head & (Capacity - 1)];
+    }
+
+    void EndPop() {
+        m_Head.store(m_Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        m_Consumer.Pops++;
+    }
+
+    static constexpr size_t GetCapacity() { return Capacity; }
+
+    // Only meaningful once both threads are done with the queue
+    Statistics GetStatistics() const {
+        Statistics result = m_Producer;
+        result.Pops = m_Consumer.Pops;
+        result.EmptyWaits = m_Consumer.EmptyWaits;
+        return result;
+    }
+private:
+    static constexpr size_t CacheLine = 64;
+
+    std::array<T, Capacity> m_Elements{};
+
+    alignas(CacheLine) std::atomic<size_t> m_Head = 0;
+    Statistics m_Consumer;
+
+    alignas(CacheLine) std::atomic<size_t> m_Tail = 0;
+    Statistics m_Producer;
+};
\ No newline at end of file
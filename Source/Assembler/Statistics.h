@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <string_view>
+#include <cstdint>
+
+// Timings and counters of one assembly, only gathered when one is passed in. The parser counts in a separate
+// instantiation of its loop, so assembling without statistics runs the same code as if they did not exist
+struct Statistics {
+    using Clock = std::chrono::steady_clock;
+
+    struct Phase {
+        std::string_view Name;
+        Clock::duration Elapsed;
+    };
+
+    // In the order they ran. Work spread over threads counts once, as the wall time of its phase
+    std::vector<Phase> Phases;
+
+    size_t Bytes = 0;
+    size_t Lines = 0;
+    // Lexed one at a time. Instructions matched whole by CanonicalInstructions take no tokens
+    size_t Tokens = 0;
+    size_t CanonicalInstructions = 0;
+    size_t Chunks = 0;
+
+    // Left empty when parsing fails
+    size_t Instructions = 0;
+    size_t Symbols = 0;
+    size_t SymbolSlots = 0;
+
+    inline Clock::duration Total() const {
+        Clock::duration total{};
+        for (const Phase& phase : Phases) {
+            total += phase.Elapsed;
+        }
+
+        return total;
+    }
+};
+
+// Adds the time from construction to Stop, or to destruction, to statistics as a phase. Does nothing without statistics
+class PhaseTimer {
+public:
+    PhaseTimer(Statistics* statistics, std::string_view name) : m_Statistics(statistics), m_Name(name) {
+        if (m_Statistics) {
+            m_Start = Statistics::Clock::now();
+        }
+    }
+
+    ~PhaseTimer() {
+        Stop();
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+    void Stop() {
+        if (m_Statistics) {
+            m_Statistics->Phases.push_back(Statistics::Phase{ m_Name, Statistics::Clock::now() - m_Start });
+            m_Statistics = nullptr;
+        }
+    }
+private:
+    Statistics* m_Statistics;
+    std::string_view m_Name;
+    Statistics::Clock::time_point m_Start;
+};
\ No newline at end of file
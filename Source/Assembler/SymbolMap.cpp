@@ -1,51 +1,202 @@
 #include "SymbolMap.h"
 
-#include <format>
+#include <algorithm>
+#include <utility>
 
-SymbolMap::SymbolMap() {
-    // Predefined symbolss
-    m_Symbols.insert({
-        { "SP",     0x0 },
-        { "LCL",    0x1 },
-        { "ARG",    0x2 },
-        { "THIS",   0x3 },
-        { "THAT",   0x4 },
-        { "SCREEN", 0x4000},
-        { "KBD",    0x6000},
-    });
+using Language::PredefinedSymbols;
 
-    for (uint16_t i = 0; i < 16; i++) {
-        m_Symbols.emplace(std::format("R{}", i), i);
+struct Predefined {
+    std::string_view Name;
+    uint16_t Value;
+    uint32_t Index = 0;
+};
+
+static constexpr size_t PredefinedMaxLength = 6;
+static constexpr size_t PredefinedTableSize = 64;
+
+static constexpr size_t PredefinedHash(std::string_view name, uint32_t seed) {
+    uint32_t hash = seed;
+    for (char character : name) {
+        hash = (hash ^ static_cast<uint8_t>(character)) * 0x01000193;
     }
+
+    return (hash ^ (hash >> 15)) & (PredefinedTableSize - 1);
 }
 
-bool SymbolMap::TryAddLabel(std::string name, uint16_t value) {
-    bool result = !Contains(name);
+static constexpr bool IsPerfect(uint32_t seed) {
+    std::array<bool, PredefinedTableSize> used{};
+    for (const auto& symbol : PredefinedSymbols) {
+        size_t index = PredefinedHash(symbol.Name, seed);
+        if (used[index]) {
+            return false;
+        }
+
+        used[index] = true;
+    }
+
+    return true;
+}
 
-    m_Symbols.try_emplace(name, value);
+static constexpr uint32_t FindPerfectSeed() {
+    uint32_t seed = 0x811C9DC5;
+    while (!IsPerfect(seed)) {
+        seed++;
+    }
+
+    return seed;
+}
+
+static constexpr uint32_t PredefinedSeed = FindPerfectSeed();
+
+// Empty entries have an empty name, which never matches because symbols are never empty
+static constexpr auto PredefinedTable = [] {
+    std::array<Predefined, PredefinedTableSize> result{};
+    for (uint32_t i = 0; i < PredefinedSymbols.size(); i++) {
+        result[PredefinedHash(PredefinedSymbols[i].Name, PredefinedSeed)] = Predefined{ PredefinedSymbols[i].Name, PredefinedSymbols[i].Value, i };
+    }
 
     return result;
+}();
+
+static_assert(std::ranges::all_of(PredefinedSymbols, [](const Language::PredefinedSymbol& symbol) { return symbol.Name.length() <= PredefinedMaxLength && PredefinedTable[PredefinedHash(symbol.Name, PredefinedSeed)].Name == symbol.Name; }));
+
+// Predefined symbols take the first indices, in the order of PredefinedSymbols, and their names are not kept in the arena
+SymbolMap::SymbolMap(std::pmr::memory_resource* resource) : m_Entries(resource), m_Slots(256, resource), m_Names(resource) {
+    m_Entries.reserve(PredefinedSymbols.size());
+    for (const auto& symbol : PredefinedSymbols) {
+        m_Entries.push_back(Entry{ 0, 0, symbol.Value, true });
+    }
+}
+
+std::optional<SymbolId> SymbolMap::TryGetPredefined(std::string_view name) {
+    if (name.length() > PredefinedMaxLength) {
+        return std::nullopt;
+    }
+
+    const Predefined& entry = PredefinedTable[PredefinedHash(name, PredefinedSeed)];
+    return entry.Name == name ? std::optional<SymbolId>(SymbolId{ entry.Index }) : std::optional<SymbolId>{};
+}
+
+uint32_t SymbolMap::Hash(std::string_view name) {
+    size_t hash = std::hash<std::string_view>{}(name);
+    return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+size_t SymbolMap::Probe(std::string_view name, uint32_t hash) const {
+    const size_t mask = m_Slots.size() - 1;
+
+    for (size_t index = hash & mask;; index = (index + 1) & mask) {
+        const Slot& slot = m_Slots[index];
+        if (slot.Index == Slot::Empty) {
+            return index;
+        }
+
+        const Entry& entry = m_Entries[slot.Index];
+        if (slot.Hash == hash && std::string_view(m_Names).substr(entry.Offset, entry.Length) == name) {
+            return index;
+        }
+    }
+}
+
+std::optional<SymbolId> SymbolMap::Find(std::string_view name) const {
+    if (auto predefined = TryGetPredefined(name)) {
+        return predefined;
+    }
+
+    const Slot& slot = m_Slots[Probe(name, Hash(name))];
+    return slot.Index != Slot::Empty ? std::optional<SymbolId>(SymbolId{ slot.Index }) : std::optional<SymbolId>{};
 }
 
-uint16_t SymbolMap::AddVariable(std::string name) {
-    if (!Contains(name)) {
-        m_Symbols.emplace(name, m_VariableAddress);
-        return m_VariableAddress++;
+void SymbolMap::Grow() {
+    std::pmr::vector<Slot> old = std::exchange(m_Slots, std::pmr::vector<Slot>(m_Slots.size() * 2, m_Slots.get_allocator()));
+    const size_t mask = m_Slots.size() - 1;
+
+    for (const Slot& slot : old) {
+        if (slot.Index == Slot::Empty) {
+            continue;
+        }
+
+        size_t index = slot.Hash & mask;
+        while (m_Slots[index].Index != Slot::Empty) {
+            index = (index + 1) & mask;
+        }
+
+        m_Slots[index] = slot;
     }
-    
-    return Get(name);
 }
 
-bool SymbolMap::Contains(const std::string& name) {
-    return m_Symbols.contains(name);
+SymbolId SymbolMap::Intern(std::string_view name) {
+    if (auto predefined = TryGetPredefined(name)) {
+        return predefined.value();
+    }
+
+    uint32_t hash = Hash(name);
+    size_t index = Probe(name, hash);
+    if (m_Slots[index].Index != Slot::Empty) {
+        return SymbolId{ m_Slots[index].Index };
+    }
+
+    // Keep the load factor at most one half
+    if (2 * (m_Entries.size() - PredefinedSymbols.size() + 1) > m_Slots.size()) {
+        Grow();
+        index = Probe(name, hash);
+    }
+
+    SymbolId symbol{ static_cast<uint32_t>(m_Entries.size()) };
+    m_Slots[index] = Slot{ hash, symbol.Index };
+    m_Entries.push_back(Entry{ static_cast<uint32_t>(m_Names.size()), static_cast<uint32_t>(name.length()), 0, false });
+    m_Names.append(name);
+
+    return symbol;
 }
 
-uint16_t SymbolMap::Get(const std::string& name) {
-    return m_Symbols.at(name);
+bool SymbolMap::TryAddLabel(std::string_view name, uint16_t value) {
+    Entry& entry = m_Entries[Intern(name).Index];
+    if (entry.Defined) {
+        return false;
+    }
+
+    entry.Value = value;
+    entry.Defined = true;
+    return true;
 }
 
-std::optional<uint16_t> SymbolMap::TryGet(const std::string& name) {
-    auto iter = m_Symbols.find(name);
+uint16_t SymbolMap::AddVariable(SymbolId symbol) {
+    Entry& entry = m_Entries[symbol.Index];
+    if (!entry.Defined) {
+        entry.Value = m_VariableAddress++;
+        entry.Defined = true;
+    }
+
+    return entry.Value;
+}
+
+uint16_t SymbolMap::AddVariable(std::string_view name) {
+    return AddVariable(Intern(name));
+}
+
+bool SymbolMap::Contains(std::string_view name) const {
+    return TryGet(name).has_value();
+}
+
+uint16_t SymbolMap::Get(std::string_view name) const {
+    return TryGet(name).value();
+}
+
+std::optional<uint16_t> SymbolMap::TryGet(std::string_view name) const {
+    return Find(name).and_then([this](SymbolId symbol) { return TryGet(symbol); });
+}
+
+std::optional<uint16_t> SymbolMap::TryGet(SymbolId symbol) const {
+    const Entry& entry = m_Entries[symbol.Index];
+    return entry.Defined ? std::optional<uint16_t>(entry.Value) : std::optional<uint16_t>{};
+}
+
+std::string_view SymbolMap::GetName(SymbolId symbol) const {
+    if (symbol.Index < PredefinedSymbols.size()) {
+        return PredefinedSymbols[symbol.Index].Name;
+    }
 
-    return iter != m_Symbols.end() ? std::optional<uint16_t>(iter->second) : std::optional<uint16_t>{};
+    const Entry& entry = m_Entries[symbol.Index];
+    return std::string_view(m_Names).substr(entry.Offset, entry.Length);
 }
\ No newline at end of file
@@ -1,22 +1,68 @@
 #pragma once
 
+#include "Language.h"
+
 #include <string>
+#include <string_view>
+#include <vector>
+#include <array>
 #include <cstdint>
 #include <optional>
-#include <unordered_map>
+#include <memory_resource>
+
+// Dense index of a distinct symbol name, assigned by SymbolMap::Intern in order of first appearance
+struct SymbolId {
+    uint32_t Index;
+
+    constexpr bool operator==(const SymbolId&) const = default;
+};
 
 class SymbolMap {
 public:
-    SymbolMap();
+    explicit SymbolMap(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    SymbolId Intern(std::string_view name);
+
+    bool TryAddLabel(std::string_view name, uint16_t value);
+    // Returns the address of the symbol, allocating the next variable address if it is not yet defined
+    uint16_t AddVariable(SymbolId symbol);
+    uint16_t AddVariable(std::string_view name);
 
-    bool TryAddLabel(std::string name, uint16_t value);
-    uint16_t AddVariable(std::string name);
+    bool Contains(std::string_view name) const;
+    uint16_t Get(std::string_view name) const;
+    std::optional<uint16_t> TryGet(std::string_view name) const;
+    std::optional<uint16_t> TryGet(SymbolId symbol) const;
 
-    bool Contains(const std::string& name);
-    uint16_t Get(const std::string& name);
-    std::optional<uint16_t> TryGet(const std::string& name);
+    std::string_view GetName(SymbolId symbol) const;
+    inline size_t Size() const { return m_Entries.size(); }
+    // Slots of the hash table, which holds every symbol but the predefined ones
+    inline size_t Capacity() const { return m_Slots.size(); }
 private:
-    std::unordered_map<std::string, uint16_t> m_Symbols;
-    uint16_t m_VariableAddress = 0x10;
-};
+    struct Entry {
+        uint32_t Offset;
+        uint32_t Length;
+        uint16_t Value;
+        bool Defined;
+    };
+
+    // Open addressing with linear probing from hash to symbol. Names are copied into one contiguous arena and referred to by offset
+    struct Slot {
+        uint32_t Hash;
+        uint32_t Index = Empty;
+
+        static constexpr uint32_t Empty = (uint32_t)-1;
+    };
+
+    static std::optional<SymbolId> TryGetPredefined(std::string_view name);
+    static uint32_t Hash(std::string_view name);
+
+    // Returns the slot of name, or the empty slot where it should be inserted
+    size_t Probe(std::string_view name, uint32_t hash) const;
+    std::optional<SymbolId> Find(std::string_view name) const;
+    void Grow();
 
+    std::pmr::vector<Entry> m_Entries;
+    std::pmr::vector<Slot> m_Slots;
+    std::pmr::string m_Names;
+    uint16_t m_VariableAddress = Language::FirstVariableAddress;
+};
\ No newline at end of file
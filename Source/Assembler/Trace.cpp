@@ -0,0 +1,93 @@
+#include "Trace.h"
+
+#include "IO/Log.h"
+
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <string>
+
+struct Event {
+    std::string_view Name;
+    std::string Detail;
+    int64_t Start;
+    int64_t End;
+};
+
+struct ThreadBuffer {
+    size_t Id;
+    std::vector<Event> Events;
+};
+
+std::atomic<bool> Trace::Detail::Enabled = false;
+
+static std::chrono::steady_clock::time_point Origin;
+
+// Buffers outlive their threads, so that zones of finished threads can still be written
+static std::mutex BuffersMutex;
+static std::vector<std::unique_ptr<ThreadBuffer>> Buffers;
+
+static ThreadBuffer& GetBuffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard lock(BuffersMutex);
+        buffer = Buffers.emplace_back(std::make_unique<ThreadBuffer>(Buffers.size())).get();
+    }
+
+    return *buffer;
+}
+
+int64_t Trace::Detail::Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Origin).count();
+}
+
+void Trace::Detail::Record(std::string_view name, std::string_view detail, int64_t start, int64_t end) {
+    GetBuffer().Events.push_back(Event{ name, std::string(detail), start, end });
+}
+
+void Trace::Enable() {
+    Origin = std::chrono::steady_clock::now();
+    Detail::Enabled.store(true, std::memory_order_release);
+}
+
+static std::string EscapeJson(std::string_view text) {
+    std::string result;
+    for (char character : text) {
+        if (character == '"' || character == '\\') {
+            result.push_back('\\');
+            result.push_back(character);
+        }
+        else if (static_cast<unsigned char>(character) < 0x20) {
+            result.append(std::format("\\u{:04x}", static_cast<unsigned>(character)));
+        }
+        else {
+            result.push_back(character);
+        }
+    }
+
+    return result;
+}
+
+// Complete events, one per zone, with times in microseconds
+bool Trace::Write(std::ostream& out) {
+    std::lock_guard lock(BuffersMutex);
+
+    Log::Message(out, "{{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    bool first = true;
+    for (const auto& buffer : Buffers) {
+        for (const Event& event : buffer->Events) {
+            Log::InlineMessage(out, "{}{{\"name\":\"{}\",\"cat\":\"assembler\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}",
+                first ? "" : ",\n", event.Name, buffer->Id, event.Start / 1e3, (event.End - event.Start) / 1e3);
+            if (!event.Detail.empty()) {
+                Log::InlineMessage(out, ",\"args\":{{\"detail\":\"{}\"}}", EscapeJson(event.Detail));
+            }
+
+            Log::InlineMessage(out, "}}");
+            first = false;
+        }
+    }
+
+    Log::Message(out, "\n]}}");
+    return out.good();
+}
\ No newline at end of file
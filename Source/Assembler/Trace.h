@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string_view>
+#include <ostream>
+#include <atomic>
+#include <cstdint>
+
+// Timeline of what every thread does, written as a Chrome Trace Event file for chrome://tracing or ui.perfetto.dev.
+// Every thread records into a buffer of its own and only locks once, to register it. While tracing is off, a zone is one relaxed load
+namespace Trace {
+    namespace Detail {
+        extern std::atomic<bool> Enabled;
+
+        // Nanoseconds since tracing was enabled
+        int64_t Now();
+        void Record(std::string_view name, std::string_view detail, int64_t start, int64_t end);
+    }
+
+    // Must be called before the threads to trace are started
+    void Enable();
+    inline bool IsEnabled() { return Detail::Enabled.load(std::memory_order_relaxed); }
+
+    // Writes every zone recorded so far. The threads that recorded them must have finished or be idle
+    bool Write(std::ostream& out);
+
+    // Records the time from construction to End, or to destruction, on the calling thread.
+    // name must outlive the trace (i.e. a literal), detail is copied once the zone ends
+    class Zone {
+    public:
+        explicit Zone(std::string_view name, std::string_view detail = {}) {
+            if (IsEnabled()) {
+                m_Name = name;
+                m_Detail = detail;
+                m_Start = Detail::Now();
+            }
+        }
+
+        ~Zone() {
+            End();
+        }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+        inline void End() {
+            if (m_Start >= 0) {
+                Detail::Record(m_Name, m_Detail, m_Start, Detail::Now());
+                m_Start = -1;
+            }
+        }
+    private:
+        std::string_view m_Name;
+        std::string_view m_Detail;
+        int64_t m_Start = -1;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+
+// Pool and worker of the current thread, so that tasks submit to the deque of their own worker
+static thread_local const WorkStealingPool* t_Pool = nullptr;
+static thread_local size_t t_Worker = 0;
+
+WorkStealingPool::WorkStealingPool(size_t threads) {
+    threads = threads != 0 ? threads : std::max(std::thread::hardware_concurrency(), 1u);
+
+    for (size_t i = 0; i < threads; i++) {
+        m_Queues.push_back(std::make_unique<Queue>());
+    }
+
+    for (size_t i = 0; i < threads; i++) {
+        m_Workers.emplace_back([this, i](std::stop_token stop) { Run(stop, i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    Wait();
+
+    for (std::jthread& worker : m_Workers) {
+        worker.request_stop();
+    }
+}
+
+void WorkStealingPool::Submit(Task task) {
+    const size_t worker = t_Pool == this ? t_Worker : m_NextQueue.fetch_add(1, std::memory_order_relaxed) % m_Queues.size();
+
+    m_Pending.fetch_add(1);
+    {
+        Queue& queue = *m_Queues[worker];
+        std::lock_guard lock(queue.Mutex);
+        queue.Tasks.push_back(std::move(task));
+    }
+
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Queued.fetch_add(1);
+    }
+
+    m_Wake.notify_one();
+}
+
+void WorkStealingPool::Wait() {
+    for (size_t pending = m_Pending.load(); pending != 0; pending = m_Pending.load()) {
+        m_Pending.wait(pending);
+    }
+}
+
+std::optional<WorkStealingPool::Task> WorkStealingPool::TryTake(size_t worker) {
+    for (size_t i = 0; i < m_Queues.size(); i++) {
+        const bool own = i == 0;
+        Queue& queue = *m_Queues[(worker + i) % m_Queues.size()];
+
+        std::lock_guard lock(queue.Mutex);
+        if (queue.Tasks.empty()) {
+            continue;
+        }
+
+        Task task;
+        if (own) {
+            task = std::move(queue.Tasks.back());
+            queue.Tasks.pop_back();
+        }
+        else {
+            task = std::move(queue.Tasks.front());
+            queue.Tasks.pop_front();
+        }
+
+        m_Queued.fetch_sub(1);
+        return task;
+    }
+
+    return std::nullopt;
+}
+
+void WorkStealingPool::Run(std::stop_token stop, size_t worker) {
+    t_Pool = this;
+    t_Worker = worker;
+
+    while (!stop.stop_requested()) {
+        if (std::optional<Task> task = TryTake(worker)) {
+            task.value()();
+            if (m_Pending.fetch_sub(1) == 1) {
+                m_Pending.notify_all();
+            }
+
+            continue;
+        }
+
+        std::unique_lock lock(m_Mutex);
+        m_Wake.wait(lock, stop, [this] { return m_Queued.load() != 0; });
+    }
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <thread>
+
+// Fixed set of worker threads, each with its own task deque. Workers take their newest task first and,
+// once their own deque is empty, steal the oldest task of another worker, so a long task only delays
+// the tasks that nobody else got to yet.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // threads is 0 for one per core
+    explicit WorkStealingPool(size_t threads);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Tasks submitted from outside the pool are dealt round robin, tasks submitted by a task go to the deque of its worker
+    void Submit(Task task);
+    // Blocks until every task submitted so far has finished
+    void Wait();
+
+    inline size_t GetThreadCount() const { return m_Workers.size(); }
+private:
+    struct alignas(64) Queue {
+        std::mutex Mutex;
+        std::deque<Task> Tasks;
+    };
+
+    std::optional<Task> TryTake(size_t worker);
+    void Run(std::stop_token stop, size_t worker);
+
+    std::vector<std::unique_ptr<Queue>> m_Queues;
+    std::atomic<size_t> m_NextQueue = 0;
+
+    // Tasks waiting in any deque, guarded by m_Mutex when incremented so that idle workers do not miss a wakeup
+    std::atomic<size_t> m_Queued = 0;
+    // Tasks submitted and not finished yet
+    std::atomic<size_t> m_Pending = 0;
+    std::mutex m_Mutex;
+    std::condition_variable_any m_Wake;
+
+    std::vector<std::jthread> m_Workers;
+};
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "Benchmark.h"
+
+#include "IO/Log.h"
+
+#include <atomic>
+#include <new>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+static std::atomic<size_t> AllocationCount;
+static std::atomic<size_t> AllocationBytes;
+
+static void* Allocate(size_t size, size_t counted) {
+    AllocationCount.fetch_add(1, std::memory_order_relaxed);
+    AllocationBytes.fetch_add(counted, std::memory_order_relaxed);
+
+    if (void* pointer = std::malloc(size != 0 ? size : 1)) {
+        return pointer;
+    }
+
+    throw std::bad_alloc();
+}
+
+// Over-aligned blocks keep the pointer malloc returned just before the aligned one.
+// The polymorphic allocators of the standard library may allocate every block this way
+static void* AllocateAligned(size_t size, std::align_val_t alignment) {
+    const size_t align = std::max(static_cast<size_t>(alignment), alignof(void*));
+    std::byte* block = static_cast<std::byte*>(Allocate(size + align + sizeof(void*), size));
+    std::byte* aligned = block + sizeof(void*) + (align - reinterpret_cast<uintptr_t>(block + sizeof(void*)) % align) % align;
+    std::memcpy(aligned - sizeof(void*), &block, sizeof(void*));
+    return aligned;
+}
+
+static void FreeAligned(void* pointer) {
+    if (pointer) {
+        void* block;
+        std::memcpy(&block, static_cast<std::byte*>(pointer) - sizeof(void*), sizeof(void*));
+        std::free(block);
+    }
+}
+
+// Array and nothrow forms forward to these
+void* operator new(size_t size) { return Allocate(size, size); }
+void* operator new(size_t size, std::align_val_t alignment) { return AllocateAligned(size, alignment); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { FreeAligned(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { FreeAligned(pointer); }
+
+Benchmark::Allocations Benchmark::GetAllocations() {
+    return Allocations{ AllocationCount.load(std::memory_order_relaxed), AllocationBytes.load(std::memory_order_relaxed) };
+}
+
+static volatile size_t Sink;
+
+void Benchmark::Keep(size_t value) {
+    Sink = Sink + value;
+}
+
+static double GetMegabytesPerSecond(const Benchmark::Result& result) {
+    return static_cast<double>(result.Bytes) / result.Seconds / 1e6;
+}
+
+static double GetInstructionsPerSecond(const Benchmark::Result& result) {
+    return static_cast<double>(result.Instructions) / result.Seconds;
+}
+
+void Benchmark::WriteJson(std::ostream& out, const Run& run, std::span<const Result> results) {
+    Log::Message(out, "{{");
+    Log::Message(out, "  \"schema\": 1,");
+    Log::Message(out, "  \"seed\": {},", run.Seed);
+    Log::Message(out, "  \"size\": {},", run.Size);
+    Log::Message(out, "  \"text_kernel\": \"{}\",", run.TextKernel);
+    Log::Message(out, "  \"benchmarks\": [");
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& result = results[i];
+        Log::Message(out, "    {{ \"name\": \"{}/{}\", \"corpus\": \"{}\", \"stage\": \"{}\", \"bytes\": {}, \"instructions\": {}, \"iterations\": {}, "
+            "\"seconds\": {:.9f}, \"mb_per_s\": {:.3f}, \"instructions_per_s\": {:.0f}, \"allocations\": {}, \"allocated_bytes\": {} }}{}",
+            result.Corpus, result.Stage, result.Corpus, result.Stage, result.Bytes, result.Instructions, result.Iterations,
+            result.Seconds, GetMegabytesPerSecond(result), GetInstructionsPerSecond(result), result.Allocated.Count, result.Allocated.Bytes,
+            i + 1 < results.size() ? "," : "");
+    }
+
+    Log::Message(out, "  ]");
+    Log::Message(out, "}}");
+}
+
+void Benchmark::WriteTable(std::ostream& out, std::span<const Result> results) {
+    Log::Message(out, "{:<12} {:<18} {:>10} {:>12} {:>10} {:>12} {:>14}", "corpus", "stage", "MB/s", "Minstr/s", "ms", "allocations", "bytes");
+    for (const Result& result : results) {
+        Log::Message(out, "{:<12} {:<18} {:>10.1f} {:>12.2f} {:>10.3f} {:>12} {:>14}", result.Corpus, result.Stage, GetMegabytesPerSecond(result),
+            GetInstructionsPerSecond(result) / 1e6, result.Seconds * 1e3, result.Allocated.Count, result.Allocated.Bytes);
+    }
+}
\ No newline at end of file
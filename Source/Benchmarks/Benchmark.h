@@ -0,0 +1,101 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <chrono>
+#include <ostream>
+#include <algorithm>
+#include <cstdint>
+
+namespace Benchmark {
+    // Counted by the global operator new of the benchmark executable, which every allocation of the library ends up in
+    struct Allocations {
+        size_t Count = 0;
+        size_t Bytes = 0;
+    };
+
+    Allocations GetAllocations();
+
+    // Times only what runs between Start and Stop, so that the set up of each iteration is left out
+    class Stopwatch {
+    public:
+        inline void Start() {
+            m_Allocations = GetAllocations();
+            m_Start = Clock::now();
+        }
+
+        inline void Stop() {
+            const Clock::time_point end = Clock::now();
+            const Allocations allocations = GetAllocations();
+            m_Elapsed += end - m_Start;
+            m_Allocated.Count += allocations.Count - m_Allocations.Count;
+            m_Allocated.Bytes += allocations.Bytes - m_Allocations.Bytes;
+        }
+
+        inline double Seconds() const { return std::chrono::duration<double>(m_Elapsed).count(); }
+        inline const Allocations& Allocated() const { return m_Allocated; }
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        Clock::time_point m_Start;
+        Clock::duration m_Elapsed{};
+        Allocations m_Allocations;
+        Allocations m_Allocated;
+    };
+
+    struct Settings {
+        std::chrono::milliseconds MinimumTime{ 500 };
+        size_t MinimumIterations = 3;
+    };
+
+    struct Result {
+        std::string Corpus;
+        std::string Stage;
+        // Processed by one iteration: the source, but for output writing, which counts what it writes
+        size_t Bytes = 0;
+        size_t Instructions = 0;
+
+        size_t Iterations = 0;
+        // Median of the iterations
+        double Seconds = 0;
+        // Of one iteration, the same for every iteration of a deterministic stage
+        Allocations Allocated;
+    };
+
+    // Keeps a value the compiler could otherwise prove unused
+    void Keep(size_t value);
+
+    // Runs iteration(Stopwatch&) once to warm up, then until both minimums of settings are met
+    template <typename Iteration>
+    Result Measure(const Settings& settings, std::string_view corpus, std::string_view stage, size_t bytes, size_t instructions, Iteration&& iteration) {
+        Stopwatch warmUp;
+        iteration(warmUp);
+
+        std::vector<double> times;
+        double total = 0;
+        Allocations allocated;
+        while (times.size() < settings.MinimumIterations || total < std::chrono::duration<double>(settings.MinimumTime).count()) {
+            Stopwatch stopwatch;
+            iteration(stopwatch);
+
+            times.push_back(stopwatch.Seconds());
+            total += stopwatch.Seconds();
+            allocated = stopwatch.Allocated();
+        }
+
+        std::ranges::nth_element(times, times.begin() + times.size() / 2);
+        return Result{ std::string(corpus), std::string(stage), bytes, instructions, times.size(), times[times.size() / 2], allocated };
+    }
+
+    struct Run {
+        uint64_t Seed;
+        size_t Size;
+        std::string_view TextKernel;
+    };
+
+    // One object per line in a fixed key order, so that results diff cleanly from run to run
+    void WriteJson(std::ostream& out, const Run& run, std::span<const Result> results);
+    void WriteTable(std::ostream& out, std::span<const Result> results);
+}
\ No newline at end of file
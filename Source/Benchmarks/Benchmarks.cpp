@@ -0,0 +1,439 @@
+#include "Benchmark.h"
+#include "Corpus.h"
+
+#include "Assembler/Lexer.h"
+#include "Assembler/SemanticToken.h"
+#include "Assembler/Parser.h"
+#include "Assembler/CodeGeneration.h"
+#include "Assembler/OutputFormat.h"
+#include "Assembler/HackText.h"
+#include "Assembler/Assemble.h"
+#include "Assembler/Scan.h"
+#include "Assembler/SymbolMap.h"
+
+#include "IO/Log.h"
+#include "IO/FileQueue.h"
+
+#include <span>
+#include <array>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <expected>
+#include <charconv>
+#include <optional>
+
+struct Options {
+    // Of each corpus
+    size_t Size = 8 << 20;
+    uint64_t Seed = 1;
+    Benchmark::Settings Settings;
+    // Only runs the benchmarks whose corpus/stage name contains this
+    std::string Filter;
+    bool Json = false;
+    // Writes the corpora there instead of running anything
+    std::optional<std::string> GenerateDirectory;
+};
+
+static constexpr std::string_view Usage = "Benchmarks [--size <MiB>] [--seed <n>] [--min-time <ms>] [--filter <corpus/stage>] [--json] [--generate <directory>]";
+
+static std::expected<Options, std::string_view> ParseArguments(std::span<char*> arguments) {
+    Options options;
+
+    for (size_t i = 1; i < arguments.size(); i++) {
+        std::string_view argument = arguments[i];
+
+        if (argument == "--json") {
+            options.Json = true;
+            continue;
+        }
+
+        if (argument != "--size" && argument != "--seed" && argument != "--min-time" && argument != "--filter" && argument != "--generate") {
+            return std::unexpected("unknown argument");
+        }
+
+        if (++i == arguments.size()) {
+            return std::unexpected("missing value for option");
+        }
+
+        std::string_view value = arguments[i];
+        if (argument == "--filter") {
+            options.Filter = value;
+            continue;
+        }
+
+        if (argument == "--generate") {
+            options.GenerateDirectory = value;
+            continue;
+        }
+
+        uint64_t number = 0;
+        auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), number);
+        if (error != std::errc() || end != value.data() + value.size()) {
+            return std::unexpected("value must be a non-negative integer");
+        }
+
+        if (argument == "--size") {
+            if (number == 0) {
+                return std::unexpected("size must be at least 1 MiB");
+            }
+
+            options.Size = static_cast<size_t>(number) << 20;
+        }
+        else if (argument == "--seed") {
+            options.Seed = number;
+        }
+        else {
+            options.Settings.MinimumTime = std::chrono::milliseconds(number);
+        }
+    }
+
+    return options;
+}
+
+struct WriteStage {
+    OutputFormat::Format Format;
+    std::string_view Name;
+};
+
+static constexpr std::array<WriteStage, 4> WriteStages = { {
+    { OutputFormat::Format::Text, "write-text" },
+    { OutputFormat::Format::Raw, "write-raw" },
+    { OutputFormat::Format::Image, "write-image" },
+    { OutputFormat::Format::IntelHex, "write-hex" },
+} };
+
+static bool IsSelected(const Options& options, std::string_view corpus, std::string_view stage) {
+    return options.Filter.empty() || std::format("{}/{}", corpus, stage).contains(options.Filter);
+}
+
+static constexpr std::array<HackText::Kernel, 3> TextKernels = { HackText::Kernel::Scalar, HackText::Kernel::Bmi2, HackText::Kernel::Ssse3 };
+
+// The runs the lexer skips, in the order it meets them, without building tokens. Compares the scan kernels on the mix of runs real sources have
+template <auto SkipWhitespace, auto SkipInteger, auto SkipSymbol, auto FindNewline>
+static size_t ScanRuns(std::string_view text) {
+    size_t runs = 0;
+    for (size_t position = 0; position < text.size(); runs++) {
+        const char character = text[position];
+        if (Scan::IsWhitespace(character)) {
+            position = SkipWhitespace(text, position);
+        }
+        else if (character == '/') {
+            position = FindNewline(text, position);
+        }
+        else if (Scan::IsNumeric(character)) {
+            position = SkipInteger(text, position);
+        }
+        else if (Scan::IsSymbol(character)) {
+            position = SkipSymbol(text, position);
+        }
+        else {
+            position++;
+        }
+    }
+
+    return runs;
+}
+
+// Every stage on its own, from the same input the stage gets when assembling, then the whole assembler.
+// The error corpus never parses, so it stops after the parser and the end to end runs
+static void MeasureCorpus(const Corpus::Source& source, const Options& options, std::vector<Benchmark::Result>& results) {
+    const std::string_view name = Corpus::GetName(source.Type);
+    const std::string_view text = source.Text;
+
+    auto selected = [&](std::string_view stage) { return IsSelected(options, name, stage); };
+    auto measure = [&](std::string_view stage, size_t bytes, size_t instructions, auto&& iteration) {
+        if (selected(stage)) {
+            results.push_back(Benchmark::Measure(options.Settings, name, stage, bytes, instructions, iteration));
+        }
+    };
+
+    measure("lexer", text.size(), source.Instructions, [&](Benchmark::Stopwatch& stopwatch) {
+        stopwatch.Start();
+        std::string_view stream = text;
+        size_t tokens = 0;
+        while (Lexer::GetNextToken(stream).Type != Lexer::TokenType::EndOfStream) {
+            tokens++;
+        }
+
+        stopwatch.Stop();
+        Benchmark::Keep(tokens);
+    });
+
+    measure("scan-scalar", text.size(), source.Instructions, [&](Benchmark::Stopwatch& stopwatch) {
+        stopwatch.Start();
+        const size_t runs = ScanRuns<Scan::Scalar::SkipWhitespace, Scan::Scalar::SkipInteger, Scan::Scalar::SkipSymbol, Scan::Scalar::FindNewline>(text);
+        stopwatch.Stop();
+        Benchmark::Keep(runs);
+    });
+
+    measure("scan-simd", text.size(), source.Instructions, [&](Benchmark::Stopwatch& stopwatch) {
+        stopwatch.Start();
+        const size_t runs = ScanRuns<Scan::SkipWhitespace, Scan::SkipInteger, Scan::SkipSymbol, Scan::FindNewline>(text);
+        stopwatch.Stop();
+        Benchmark::Keep(runs);
+    });
+
+    if (selected("semantic-create")) {
+        std::vector<Lexer::Token> tokens;
+        std::string_view stream = text;
+        for (Lexer::Token token = Lexer::GetNextToken(stream); token.Type != Lexer::TokenType::EndOfStream; token = Lexer::GetNextToken(stream)) {
+            tokens.push_back(token);
+        }
+
+        measure("semantic-create", text.size(), source.Instructions, [&](Benchmark::Stopwatch& stopwatch) {
+            stopwatch.Start();
+            size_t valid = 0;
+            for (const Lexer::Token& token : tokens) {
+                valid += SemanticToken::Create(token).has_value();
+            }
+
+            stopwatch.Stop();
+            Benchmark::Keep(valid);
+        });
+    }
+
+    measure("semantic-lexer", text.size(), source.Instructions, [&](Benchmark::Stopwatch& stopwatch) {
+        stopwatch.Start();
+        std::string_view stream = text;
+        size_t valid = 0;
+        for (bool more = true; more;) {
+            SemanticToken::Lexed lexed = SemanticToken::Lex(stream);
+            valid += lexed.Semantic.has_value();
+            more = lexed.Token.Type != Lexer::TokenType::EndOfStream;
+        }
+
+        stopwatch.Stop();
+        Benchmark::Keep(valid);
+    });
+
+    measure("parse", text.size(), source.Instructions, [&](Benchmark::Stopwatch& stopwatch) {
+        stopwatch.Start();
+        IO::Diagnostics diagnostics{ std::string(name) };
+        auto parsed = Parser::Parse(text, diagnostics);
+        stopwatch.Stop();
+        Benchmark::Keep(parsed.has_value() ? parsed.value().Instructions.Size() : diagnostics.ErrorCount());
+    });
+
+    auto code = Assembler::Assemble(text);
+    if (code.has_value()) {
+        measure("generate-code", text.size(), source.Instructions, [&](Benchmark::Stopwatch& stopwatch) {
+            IO::Diagnostics diagnostics{ std::string(name) };
+            auto parsed = Parser::Parse(text, diagnostics);
+
+            stopwatch.Start();
+            std::vector<uint16_t> generated = CodeGeneration::GenerateCode(parsed.value());
+            stopwatch.Stop();
+            Benchmark::Keep(generated.size());
+        });
+
+        for (const WriteStage& stage : WriteStages) {
+            std::string output(OutputFormat::GetSize(code.value(), stage.Format), '\0');
+            measure(stage.Name, output.size(), code.value().size(), [&](Benchmark::Stopwatch& stopwatch) {
+                stopwatch.Start();
+                OutputFormat::Write(code.value(), stage.Format, output.data(), 1);
+                stopwatch.Stop();
+                Benchmark::Keep(static_cast<size_t>(output.back()));
+            });
+        }
+
+        // Every kernel the CPU supports, on the text of the same code. Both directions count the bytes of text
+        std::string text(code.value().size() * HackText::LineWidth, '\0');
+        HackText::Encode(code.value(), text.data());
+        for (HackText::Kernel kernel : TextKernels) {
+            if (!HackText::IsSupported(kernel)) {
+                continue;
+            }
+
+            measure(std::format("encode-{}", HackText::GetName(kernel)), text.size(), code.value().size(), [&](Benchmark::Stopwatch& stopwatch) {
+                std::string encoded(text.size(), '\0');
+                stopwatch.Start();
+                HackText::Encode(code.value(), encoded.data(), kernel);
+                stopwatch.Stop();
+                Benchmark::Keep(static_cast<size_t>(encoded.back()));
+            });
+
+            measure(std::format("decode-{}", HackText::GetName(kernel)), text.size(), code.value().size(), [&](Benchmark::Stopwatch& stopwatch) {
+                stopwatch.Start();
+                auto decoded = HackText::Decode(text, kernel);
+                stopwatch.Stop();
+                Benchmark::Keep(decoded.has_value() ? decoded.value().size() : decoded.error());
+            });
+        }
+    }
+
+    for (size_t jobs : { 1, 0 }) {
+        measure(jobs == 1 ? "assemble" : "assemble-parallel", text.size(), source.Instructions, [&](Benchmark::Stopwatch& stopwatch) {
+            Assembler::Options assemblerOptions{ .SourceName = std::string(name), .Jobs = jobs };
+
+            stopwatch.Start();
+            auto assembled = Assembler::Assemble(text, assemblerOptions);
+            stopwatch.Stop();
+            Benchmark::Keep(assembled.has_value() ? assembled.value().size() : assembled.error().ErrorCount);
+        });
+    }
+}
+
+// Half of the names are defined as labels, then every name is referenced as a variable twice: the first
+// pass allocates the other half, the second only finds names
+static constexpr size_t SymbolCount = 200000;
+
+static void MeasureSymbols(const Options& options, std::vector<Benchmark::Result>& results) {
+    constexpr std::string_view name = "symbols";
+    constexpr std::string_view stage = "labels-variables";
+    if (!IsSelected(options, name, stage)) {
+        return;
+    }
+
+    const std::vector<std::string> names = Corpus::GenerateSymbols(SymbolCount, options.Seed);
+    size_t bytes = 0;
+    for (const std::string& symbol : names) {
+        bytes += symbol.size();
+    }
+
+    const size_t labels = SymbolCount / 2;
+    const size_t operations = labels + 2 * SymbolCount;
+    results.push_back(Benchmark::Measure(options.Settings, name, stage, bytes, operations, [&](Benchmark::Stopwatch& stopwatch) {
+        size_t sum = 0;
+
+        stopwatch.Start();
+        SymbolMap symbols;
+        for (size_t i = 0; i < labels; i++) {
+            sum += symbols.TryAddLabel(names[i], static_cast<uint16_t>(i));
+        }
+
+        for (size_t pass = 0; pass < 2; pass++) {
+            for (const std::string& symbol : names) {
+                sum += symbols.AddVariable(symbol);
+            }
+        }
+        stopwatch.Stop();
+
+        Benchmark::Keep(sum + symbols.Size());
+    }));
+}
+
+// A batch of many small files, like the output of a VM translator for a whole project
+static constexpr size_t BatchFileCount = 10000;
+static constexpr size_t BatchFileSize = 2 << 10;
+
+struct BatchStage {
+    IO::FileQueue::Backend Backend;
+    std::string_view Name;
+};
+
+static constexpr std::array<BatchStage, 2> BatchStages = { {
+    { IO::FileQueue::Backend::IoUring, "io-uring" },
+    { IO::FileQueue::Backend::Blocking, "io-blocking" },
+} };
+
+// Only the I/O of batch mode: every input is read and written back to its output through each backend, in the order batch mode does.
+// The files are written once beforehand, so the reads come from the page cache
+static void MeasureFileQueue(const Options& options, std::vector<Benchmark::Result>& results) {
+    constexpr std::string_view name = "files";
+    auto selected = [&](std::string_view stage) { return IsSelected(options, name, stage); };
+    if (std::ranges::none_of(BatchStages, [&](const BatchStage& stage) { return selected(stage.Name); })) {
+        return;
+    }
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / std::format("hack-benchmarks-{}", options.Seed);
+    std::filesystem::create_directories(directory);
+
+    std::vector<std::string> inputs;
+    std::vector<std::string> outputs;
+    size_t bytes = 0;
+    size_t instructions = 0;
+    for (size_t i = 0; i < BatchFileCount; i++) {
+        const Corpus::Source source = Corpus::Generate(Corpus::Kind::Handwritten, BatchFileSize, options.Seed + i);
+        inputs.push_back((directory / std::format("{:05}.asm", i)).string());
+        outputs.push_back((directory / std::format("{:05}.hack", i)).string());
+
+        std::ofstream file(inputs.back(), std::ios::out | std::ios::binary);
+        file.write(source.Text.data(), static_cast<std::streamsize>(source.Text.size()));
+        bytes += source.Text.size();
+        instructions += source.Instructions;
+    }
+
+    for (const BatchStage& stage : BatchStages) {
+        if (!selected(stage.Name)) {
+            continue;
+        }
+
+        if (IO::FileQueue({}, stage.Backend).GetBackend() != stage.Backend) {
+            Log::Message(std::cerr, "{}/{}: backend not available, skipped", name, stage.Name);
+            continue;
+        }
+
+        results.push_back(Benchmark::Measure(options.Settings, name, stage.Name, bytes, instructions, [&](Benchmark::Stopwatch& stopwatch) {
+            size_t read = 0;
+            size_t failed = 0;
+
+            stopwatch.Start();
+            {
+                IO::FileQueue files(inputs, stage.Backend);
+                while (auto input = files.TakeNext()) {
+                    const std::string_view text = input.value().File.has_value() ? input.value().File.value().View() : std::string_view();
+                    read += text.size();
+                    files.Write(outputs[input.value().Index], std::string(text));
+                }
+
+                failed = files.Flush().size();
+            }
+            stopwatch.Stop();
+
+            Benchmark::Keep(read + failed);
+        }));
+    }
+
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+}
+
+static bool Generate(const Options& options) {
+    for (Corpus::Kind kind : Corpus::Kinds) {
+        const std::filesystem::path path = std::filesystem::path(options.GenerateDirectory.value()) / std::format("{}.asm", Corpus::GetName(kind));
+        const Corpus::Source source = Corpus::Generate(kind, options.Size, options.Seed);
+
+        std::ofstream file(path, std::ios::out | std::ios::binary);
+        file.write(source.Text.data(), static_cast<std::streamsize>(source.Text.size()));
+        if (!file.good()) {
+            Log::Message(std::cerr, "Could not write {}", path.string());
+            return false;
+        }
+
+        Log::Message("{}: {} bytes, {} lines, {} instructions", path.string(), source.Text.size(), source.Lines, source.Instructions);
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv) {
+    auto options = ParseArguments({ argv, static_cast<size_t>(argc) });
+    if (!options.has_value()) {
+        Log::Message(std::cerr, "benchmarks: {}", options.error());
+        Log::Message(std::cerr, "usage: {}", Usage);
+        return 1;
+    }
+
+    if (options.value().GenerateDirectory.has_value()) {
+        return Generate(options.value()) ? 0 : 1;
+    }
+
+    std::vector<Benchmark::Result> results;
+    for (Corpus::Kind kind : Corpus::Kinds) {
+        MeasureCorpus(Corpus::Generate(kind, options.value().Size, options.value().Seed), options.value(), results);
+    }
+
+    MeasureSymbols(options.value(), results);
+    MeasureFileQueue(options.value(), results);
+
+    if (options.value().Json) {
+        Benchmark::WriteJson(std::cout, Benchmark::Run{ options.value().Seed, options.value().Size, HackText::GetName(HackText::GetKernel()) }, results);
+    }
+    else {
+        Benchmark::WriteTable(std::cout, results);
+    }
+
+    return 0;
+}
\ No newline at end of file
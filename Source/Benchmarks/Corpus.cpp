@@ -0,0 +1,507 @@
+#include "Corpus.h"
+
+#include <array>
+#include <vector>
+#include <format>
+#include <algorithm>
+#include <iterator>
+#include <initializer_list>
+
+// SplitMix64, so that the sequence does not depend on the standard library like the std:: distributions do
+class Random {
+public:
+    explicit Random(uint64_t seed) : m_State(seed) {}
+
+    uint64_t Next() {
+        uint64_t result = (m_State += 0x9E3779B97F4A7C15);
+        result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9;
+        result = (result ^ (result >> 27)) * 0x94D049BB133111EB;
+        return result ^ (result >> 31);
+    }
+
+    size_t Below(size_t bound) { return static_cast<size_t>(Next() % bound); }
+    bool Chance(size_t percent) { return Below(100) < percent; }
+
+    template <typename T, size_t N>
+    const T& Pick(const std::array<T, N>& values) { return values[Below(N)]; }
+private:
+    uint64_t m_State;
+};
+
+static void Line(Corpus::Source& source, std::string_view line) {
+    source.Text.append(line);
+    source.Text.push_back('\n');
+    source.Lines++;
+}
+
+static void Instruction(Corpus::Source& source, std::string_view line) {
+    Line(source, line);
+    source.Instructions++;
+}
+
+static void Instructions(Corpus::Source& source, std::initializer_list<std::string_view> lines) {
+    for (std::string_view line : lines) {
+        Instruction(source, line);
+    }
+}
+
+// Translated
+
+static constexpr std::array<std::string_view, 16> ClassNames = {
+    "Main", "Math", "Memory", "Screen", "Output", "Keyboard", "String", "Array",
+    "Sys", "Ball", "Bat", "PongGame", "Square", "SquareGame", "List", "Node",
+};
+
+static constexpr size_t ClassCount = 64;
+static constexpr size_t StaticsPerClass = 32;
+
+static constexpr std::array<std::string_view, 4> Segments = { "local", "argument", "this", "that" };
+static constexpr std::array<std::string_view, 4> SegmentBases = { "LCL", "ARG", "THIS", "THAT" };
+
+struct BinaryCommand {
+    std::string_view Name;
+    std::string_view Compute;
+};
+
+static constexpr std::array<BinaryCommand, 4> BinaryCommands = { {
+    { "add", "M=D+M" }, { "sub", "M=M-D" }, { "and", "M=D&M" }, { "or", "M=D|M" },
+} };
+
+static constexpr std::array<BinaryCommand, 2> UnaryCommands = { {
+    { "neg", "M=-M" }, { "not", "M=!M" },
+} };
+
+struct Comparison {
+    std::string_view Name;
+    std::string_view Jump;
+};
+
+static constexpr std::array<Comparison, 3> Comparisons = { {
+    { "eq", "JEQ" }, { "gt", "JGT" }, { "lt", "JLT" },
+} };
+
+class Translator {
+public:
+    Translator(Corpus::Source& source, Random& random) : m_Source(source), m_Random(random) {}
+
+    // Every call targets Sys.init or a function generated before it, so every label is defined
+    void Function() {
+        const size_t classIndex = m_Functions.empty() ? 8 : m_Random.Below(ClassCount);
+        m_Class = GetClassName(classIndex);
+        m_Function = m_Functions.empty() ? std::string("Sys.init") : std::format("{}.f{}", m_Class, m_Functions.size());
+        m_Labels = 1 + m_Random.Below(4);
+        m_DefinedLabels = 0;
+        m_Returns = 0;
+        m_Comparisons = 0;
+
+        const size_t locals = m_Random.Below(5);
+        Line(m_Source, "");
+        Line(m_Source, std::format("// {}", std::string(60, '/')));
+        Line(m_Source, std::format("// function {} {}", m_Function, locals));
+        Line(m_Source, std::format("({})", m_Function));
+        for (size_t i = 0; i < locals; i++) {
+            Push("constant", 0);
+        }
+
+        const size_t commands = 20 + m_Random.Below(100);
+        for (size_t i = 0; i < commands; i++) {
+            Command();
+        }
+
+        while (m_DefinedLabels < m_Labels) {
+            DefineLabel();
+        }
+
+        Return();
+        m_Functions.push_back(m_Function);
+    }
+private:
+    static std::string GetClassName(size_t index) {
+        return index < ClassNames.size() ? std::string(ClassNames[index]) : std::format("{}{}", ClassNames[index % ClassNames.size()], index / ClassNames.size());
+    }
+
+    void PushD() {
+        Instructions(m_Source, { "@SP", "AM=M+1", "A=A-1", "M=D" });
+    }
+
+    void PopD() {
+        Instructions(m_Source, { "@SP", "AM=M-1", "D=M" });
+    }
+
+    void Push(std::string_view segment, size_t index) {
+        Line(m_Source, std::format("// push {} {}", segment, index));
+        if (segment == "constant") {
+            Instruction(m_Source, std::format("@{}", index));
+            Instruction(m_Source, "D=A");
+        }
+        else if (segment == "static") {
+            Instruction(m_Source, std::format("@{}.{}", m_Class, index));
+            Instruction(m_Source, "D=M");
+        }
+        else if (segment == "temp") {
+            Instruction(m_Source, std::format("@R{}", 5 + index));
+            Instruction(m_Source, "D=M");
+        }
+        else {
+            Instruction(m_Source, std::format("@{}", index));
+            Instruction(m_Source, "D=A");
+            Instruction(m_Source, std::format("@{}", SegmentBases[std::distance(Segments.begin(), std::ranges::find(Segments, segment))]));
+            Instructions(m_Source, { "A=D+M", "D=M" });
+        }
+
+        PushD();
+    }
+
+    void Pop(std::string_view segment, size_t index) {
+        Line(m_Source, std::format("// pop {} {}", segment, index));
+        if (segment == "static" || segment == "temp") {
+            PopD();
+            Instruction(m_Source, segment == "static" ? std::format("@{}.{}", m_Class, index) : std::format("@R{}", 5 + index));
+            Instruction(m_Source, "M=D");
+            return;
+        }
+
+        Instruction(m_Source, std::format("@{}", index));
+        Instruction(m_Source, "D=A");
+        Instruction(m_Source, std::format("@{}", SegmentBases[std::distance(Segments.begin(), std::ranges::find(Segments, segment))]));
+        Instructions(m_Source, { "D=D+M", "@R13", "M=D" });
+        PopD();
+        Instructions(m_Source, { "@R13", "A=M", "M=D" });
+    }
+
+    std::string GetLabel(size_t index) const {
+        return std::format("{}$L{}", m_Function, index);
+    }
+
+    void DefineLabel() {
+        std::string label = GetLabel(m_DefinedLabels++);
+        Line(m_Source, std::format("// label {}", label));
+        Line(m_Source, std::format("({})", label));
+    }
+
+    void Command() {
+        const size_t choice = m_Random.Below(100);
+        if (choice < 25) {
+            Push("constant", m_Random.Below(choice < 5 ? 32768 : 32));
+        }
+        else if (choice < 45) {
+            const bool push = m_Random.Chance(60);
+            std::string_view segment = m_Random.Pick(Segments);
+            push ? Push(segment, m_Random.Below(8)) : Pop(segment, m_Random.Below(8));
+        }
+        else if (choice < 55) {
+            m_Random.Chance(50) ? Push("static", m_Random.Below(StaticsPerClass)) : Pop("static", m_Random.Below(StaticsPerClass));
+        }
+        else if (choice < 58) {
+            m_Random.Chance(50) ? Push("temp", m_Random.Below(8)) : Pop("temp", m_Random.Below(8));
+        }
+        else if (choice < 70) {
+            const BinaryCommand& command = m_Random.Pick(BinaryCommands);
+            Line(m_Source, std::format("// {}", command.Name));
+            Instructions(m_Source, { "@SP", "AM=M-1", "D=M", "A=A-1", command.Compute });
+        }
+        else if (choice < 74) {
+            const BinaryCommand& command = m_Random.Pick(UnaryCommands);
+            Line(m_Source, std::format("// {}", command.Name));
+            Instructions(m_Source, { "@SP", "A=M-1", command.Compute });
+        }
+        else if (choice < 82) {
+            const Comparison& comparison = m_Random.Pick(Comparisons);
+            std::string label = std::format("{}$CMP{}", m_Function, m_Comparisons++);
+            Line(m_Source, std::format("// {}", comparison.Name));
+            Instructions(m_Source, { "@SP", "AM=M-1", "D=M", "A=A-1", "D=M-D", "M=-1" });
+            Instruction(m_Source, std::format("@{}", label));
+            Instruction(m_Source, std::format("D;{}", comparison.Jump));
+            Instructions(m_Source, { "@SP", "A=M-1", "M=0" });
+            Line(m_Source, std::format("({})", label));
+        }
+        else if (choice < 86) {
+            if (m_DefinedLabels < m_Labels) {
+                DefineLabel();
+            }
+        }
+        else if (choice < 92) {
+            std::string label = GetLabel(m_Random.Below(m_Labels));
+            if (m_Random.Chance(50)) {
+                Line(m_Source, std::format("// goto {}", label));
+                Instruction(m_Source, std::format("@{}", label));
+                Instruction(m_Source, "0;JMP");
+            }
+            else {
+                Line(m_Source, std::format("// if-goto {}", label));
+                PopD();
+                Instruction(m_Source, std::format("@{}", label));
+                Instruction(m_Source, "D;JNE");
+            }
+        }
+        else {
+            Call(m_Functions.empty() ? m_Function : m_Functions[m_Random.Below(m_Functions.size())], m_Random.Below(4));
+        }
+    }
+
+    void Call(std::string_view function, size_t arguments) {
+        std::string label = std::format("{}$ret.{}", m_Function, m_Returns++);
+        Line(m_Source, std::format("// call {} {}", function, arguments));
+        Instruction(m_Source, std::format("@{}", label));
+        Instruction(m_Source, "D=A");
+        PushD();
+        for (std::string_view base : SegmentBases) {
+            Instruction(m_Source, std::format("@{}", base));
+            Instruction(m_Source, "D=M");
+            PushD();
+        }
+
+        Instructions(m_Source, { "@SP", "D=M" });
+        Instruction(m_Source, std::format("@{}", 5 + arguments));
+        Instructions(m_Source, { "D=D-A", "@ARG", "M=D", "@SP", "D=M", "@LCL", "M=D" });
+        Instruction(m_Source, std::format("@{}", function));
+        Instruction(m_Source, "0;JMP");
+        Line(m_Source, std::format("({})", label));
+    }
+
+    void Return() {
+        Line(m_Source, "// return");
+        Instructions(m_Source, { "@LCL", "D=M", "@R13", "M=D", "@5", "A=D-A", "D=M", "@R14", "M=D" });
+        PopD();
+        Instructions(m_Source, { "@ARG", "A=M", "M=D", "@ARG", "D=M+1", "@SP", "M=D" });
+        for (auto base = SegmentBases.rbegin(); base != SegmentBases.rend(); base++) {
+            Instructions(m_Source, { "@R13", "AM=M-1", "D=M" });
+            Instruction(m_Source, std::format("@{}", *base));
+            Instruction(m_Source, "M=D");
+        }
+
+        Instructions(m_Source, { "@R14", "A=M", "0;JMP" });
+    }
+
+    Corpus::Source& m_Source;
+    Random& m_Random;
+
+    std::vector<std::string> m_Functions;
+    std::string m_Class;
+    std::string m_Function;
+    size_t m_Labels = 0;
+    size_t m_DefinedLabels = 0;
+    size_t m_Returns = 0;
+    size_t m_Comparisons = 0;
+};
+
+// Handwritten
+
+// Every base takes up to VariablesPerBase suffixes, which keeps the addresses of all variables below the screen
+static constexpr std::array<std::string_view, 12> VariableBases = {
+    "i", "j", "n", "sum", "count", "ptr", "addr", "value", "tmp", "x", "y", "limit",
+};
+
+static constexpr size_t VariablesPerBase = 1000;
+
+static constexpr std::array<std::string_view, 8> Remarks = {
+    "load the next element", "advance the pointer", "keep the running total", "compare against the limit",
+    "done with this row", "store the result back", "draw one word of the screen", "wait for a key",
+};
+
+static constexpr std::array<std::string_view, 6> Indents = { "", "    ", "    ", "    ", "\t", "  " };
+
+struct Statement {
+    std::string_view Compact;
+    std::string_view Spaced;
+};
+
+static constexpr std::array<Statement, 12> Statements = { {
+    { "D=M", "D = M" }, { "M=D", "M = D" }, { "D=D+M", "D = D + M" }, { "D=D-M", "D = D - M" },
+    { "M=M+1", "M = M + 1" }, { "M=M-1", "M = M - 1" }, { "D=A", "D = A" }, { "AM=M+1", "AM = M + 1" },
+    { "MD=D+1", "MD = D + 1" }, { "D=D&M", "D = D & M" }, { "M=D|M", "M = D | M" }, { "A=M", "A = M" },
+} };
+
+static constexpr std::array<std::string_view, 5> Registers = { "SCREEN", "KBD", "R7", "THIS", "SP" };
+static constexpr std::array<std::string_view, 4> LoopJumps = { "JGT", "JNE", "JLT", "JGE" };
+
+class Handwriter {
+public:
+    Handwriter(Corpus::Source& source, Random& random) : m_Source(source), m_Random(random) {}
+
+    void Block() {
+        const size_t block = m_Blocks++;
+        m_Indent = m_Random.Pick(Indents);
+
+        Line(m_Source, "");
+        Line(m_Source, std::format("// Block {}: {}", block, m_Random.Pick(Remarks)));
+        if (m_Random.Chance(30)) {
+            Line(m_Source, "//");
+            Line(m_Source, std::format("// {} and {}", m_Random.Pick(Remarks), m_Random.Pick(Remarks)));
+        }
+
+        Line(m_Source, std::format("(LOOP_{})", block));
+
+        const size_t statements = 4 + m_Random.Below(24);
+        bool skip = false;
+        for (size_t i = 0; i < statements; i++) {
+            if (!skip && m_Random.Chance(8)) {
+                Statement(std::format("@SKIP_{}", block));
+                Statement(m_Random.Chance(50) ? "D;JEQ" : "D ; JEQ");
+                skip = true;
+                continue;
+            }
+
+            if (m_Random.Chance(10)) {
+                Line(m_Source, "");
+            }
+
+            const size_t choice = m_Random.Below(100);
+            if (choice < 45) {
+                Statement(std::format("@{}_{}", m_Random.Pick(VariableBases), m_Random.Below(VariablesPerBase)));
+            }
+            else if (choice < 55) {
+                Statement(std::format("@{}", m_Random.Below(choice < 50 ? 16 : 32768)));
+            }
+            else if (choice < 62) {
+                Statement(std::format("@{}", m_Random.Pick(Registers)));
+            }
+
+            const auto& statement = m_Random.Pick(Statements);
+            Statement(m_Random.Chance(30) ? statement.Spaced : statement.Compact);
+        }
+
+        if (skip) {
+            Line(m_Source, std::format("(SKIP_{})", block));
+        }
+
+        Statement(std::format("@LOOP_{}", block));
+        Statement(std::format("D;{}", m_Random.Pick(LoopJumps)));
+        Line(m_Source, std::format("(END_{})", block));
+    }
+private:
+    void Statement(std::string_view statement) {
+        std::string line = std::format("{}{}", m_Indent, statement);
+        if (m_Random.Chance(20)) {
+            line += std::format("{}// {}", std::string(1 + m_Random.Below(12), ' '), m_Random.Pick(Remarks));
+        }
+
+        Instruction(m_Source, line);
+    }
+
+    Corpus::Source& m_Source;
+    Random& m_Random;
+
+    size_t m_Blocks = 0;
+    std::string_view m_Indent;
+};
+
+// Errors
+
+static constexpr std::array<std::string_view, 8> ValidLines = {
+    "@SP", "AM=M-1", "D=M", "@counter", "M=D+M", "0;JMP", "D;JGT", "@1234",
+};
+
+static constexpr std::array<std::string_view, 16> InvalidLines = {
+    "D=X+1", "AMD=D+D", "D=D+A+1", "D;JXX", "M=M*2", "0;jmp", "D=M;;JMP", "#$%^&",
+    "@70000", "@999999999999999999999", "@1abc", "A=D+", "=M", "D=1+", "M=D-1;", "@@SP",
+};
+
+static constexpr std::array<std::string_view, 4> InvalidLabels = {
+    "(1LOOP)", "(LOOP", "()", "(A B)",
+};
+
+static void ErrorLine(Corpus::Source& source, Random& random, size_t& labels) {
+    const size_t choice = random.Below(100);
+    if (choice < 40) {
+        Instruction(source, random.Pick(ValidLines));
+    }
+    else if (choice < 75) {
+        Instruction(source, random.Pick(InvalidLines));
+    }
+    else if (choice < 82) {
+        Line(source, random.Pick(InvalidLabels));
+    }
+    else if (choice < 88) {
+        // Every other one redefines the label before it
+        Line(source, std::format("(DUPLICATE_{})", labels++ / 2));
+    }
+    else if (choice < 92) {
+        std::string line = "D=D+A";
+        for (size_t i = random.Below(40); i > 0; i--) {
+            line += random.Chance(50) ? "+D" : "-A";
+        }
+
+        Instruction(source, line);
+    }
+    else if (choice < 95) {
+        Instruction(source, std::format("@{}", std::string(64 + random.Below(192), 'x')));
+    }
+    else {
+        Line(source, std::format("// {}", random.Below(1000)));
+    }
+}
+
+std::string_view Corpus::GetName(Kind kind) {
+    switch (kind) {
+    case Kind::Translated:  return "translated";
+    case Kind::Handwritten: return "handwritten";
+    case Kind::Errors:      return "errors";
+    }
+
+    return "";
+}
+
+std::vector<std::string> Corpus::GenerateSymbols(size_t count, uint64_t seed) {
+    Random random(seed);
+    std::vector<std::string> names;
+    names.reserve(count);
+
+    // The index keeps every name distinct
+    for (size_t i = 0; i < count; i++) {
+        const std::string_view className = random.Pick(ClassNames);
+        switch (random.Below(3)) {
+        case 0:
+            names.push_back(std::format("{}.f{}$WHILE_END{}", className, random.Below(64), i));
+            break;
+        case 1:
+            names.push_back(std::format("{}.{}", className, i));
+            break;
+        default:
+            names.push_back(std::format("{}_{}", random.Pick(VariableBases), i));
+            break;
+        }
+    }
+
+    for (size_t i = count; i > 1; i--) {
+        std::swap(names[i - 1], names[random.Below(i)]);
+    }
+
+    return names;
+}
+
+Corpus::Source Corpus::Generate(Kind kind, size_t size, uint64_t seed) {
+    Source source;
+    source.Type = kind;
+    source.Text.reserve(size + (1 << 16));
+    Random random(seed);
+
+    switch (kind) {
+    case Kind::Translated: {
+        Translator translator(source, random);
+        while (source.Text.size() < size) {
+            translator.Function();
+        }
+
+        break;
+    }
+    case Kind::Handwritten: {
+        Handwriter writer(source, random);
+        while (source.Text.size() < size) {
+            writer.Block();
+        }
+
+        break;
+    }
+    case Kind::Errors: {
+        size_t labels = 0;
+        while (source.Text.size() < size) {
+            ErrorLine(source, random, labels);
+        }
+
+        break;
+    }
+    }
+
+    return source;
+}
\ No newline at end of file
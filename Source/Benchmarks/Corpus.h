@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <string_view>
+#include <cstdint>
+
+// Deterministic synthetic Hack sources. The same kind, size and seed give the same text on every platform and compiler
+namespace Corpus {
+    enum class Kind : uint8_t {
+        // Output of a VM translator: a comment per VM command, dense generated labels and static variables of many classes
+        Translated,
+        // Hand written style: indentation, trailing comments, blank lines, spaced expressions and many distinct variables
+        Handwritten,
+        // Mostly invalid lines of every kind the parser reports, mixed with valid ones
+        Errors,
+    };
+
+    constexpr Kind Kinds[] = { Kind::Translated, Kind::Handwritten, Kind::Errors };
+
+    struct Source {
+        Kind Type;
+        std::string Text;
+        // Lines holding an instruction, valid or not
+        size_t Instructions = 0;
+        size_t Lines = 0;
+    };
+
+    std::string_view GetName(Kind kind);
+
+    // Generates whole functions or blocks until the text is at least size bytes long
+    Source Generate(Kind kind, size_t size, uint64_t seed);
+
+    // Distinct symbol names in the styles of both kinds of source: function labels, static variables and plain variables, shuffled
+    std::vector<std::string> GenerateSymbols(size_t count, uint64_t seed);
+}
\ No newline at end of file
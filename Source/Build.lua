@@ -1,3 +1,43 @@
+project "AssemblerLibrary"
+   kind "StaticLib"
+   language "C++"
+   cppdialect "C++23"
+   staticruntime "off"
+
+   -- Everything but the command line: parsing, code generation and diagnostics, without any file I/O
+   files {
+      "./Assembler/**.h", "./Assembler/**.cpp",
+      "./IO/Diagnostics.h", "./IO/Diagnostics.cpp",
+      "./IO/LineIndex.h", "./IO/LineIndex.cpp",
+   }
+
+   includedirs{
+       "./",
+   }
+
+   targetdir ("../Binaries/" .. OutputDir .. "/%{prj.name}")
+   objdir ("../Binaries/Intermediates/" .. OutputDir .. "/%{prj.name}")
+
+   filter "system:linux"
+       links { "pthread" }
+
+   filter "configurations:Debug"
+       defines { "DEBUG" }
+       runtime "Debug"
+       symbols "On"
+
+   filter "configurations:Release"
+       defines { "RELEASE" }
+       runtime "Release"
+       optimize "On"
+       symbols "On"
+
+   filter "configurations:Dist"
+       defines { "DIST" }
+       runtime "Release"
+       optimize "On"
+       symbols "Off"
+
 project "Assembler"
    kind "ConsoleApp"
    language "C++"
@@ -6,16 +46,73 @@ project "Assembler"
    staticruntime "off"
 
    files { 
-      "./**.h", "./**.cpp",
+      "./Assembler.cpp",
+      "./IO/**.h", "./IO/**.cpp",
+   }
+
+   removefiles {
+      "./IO/Diagnostics.h", "./IO/Diagnostics.cpp",
+      "./IO/LineIndex.h", "./IO/LineIndex.cpp",
+   }
+
+   includedirs{
+       "./",
+   }
+
+   links {
+       "AssemblerLibrary",
+   }
+
+   targetdir ("../Binaries/" .. OutputDir .. "/%{prj.name}")
+   objdir ("../Binaries/Intermediates/" .. OutputDir .. "/%{prj.name}")
+
+   filter "system:linux"
+       links { "pthread" }
+
+   filter "configurations:Debug"
+       defines { "DEBUG" }
+       runtime "Debug"
+       symbols "On"
+
+   filter "configurations:Release"
+       defines { "RELEASE" }
+       runtime "Release"
+       optimize "On"
+       symbols "On"
+
+   filter "configurations:Dist"
+       defines { "DIST" }
+       runtime "Release"
+       optimize "On"
+       symbols "Off"
+
+project "Benchmarks"
+   kind "ConsoleApp"
+   language "C++"
+   cppdialect "C++23"
+   staticruntime "off"
+
+   -- Batch mode's file I/O is measured too, it is not part of the library
+   files {
+      "./Benchmarks/**.h", "./Benchmarks/**.cpp",
+      "./IO/FileQueue.h", "./IO/FileQueue.cpp",
+      "./IO/MappedFile.h", "./IO/MappedFile.cpp",
    }
 
    includedirs{
        "./",
    }
 
+   links {
+       "AssemblerLibrary",
+   }
+
    targetdir ("../Binaries/" .. OutputDir .. "/%{prj.name}")
    objdir ("../Binaries/Intermediates/" .. OutputDir .. "/%{prj.name}")
 
+   filter "system:linux"
+       links { "pthread" }
+
    filter "configurations:Debug"
        defines { "DEBUG" }
        runtime "Debug"
@@ -1,20 +1,58 @@
 #pragma once
 
+#include "Diagnostics.h"
+#include "FileQueue.h"
+
+#include "Assembler/OutputFormat.h"
+
 #include <span>
 #include <string>
 #include <string_view>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
 #include <expected>
+#include <charconv>
+#include <limits>
 
 namespace CLI {
+    // Passed as a file name to read from standard input or write to standard output
+    constexpr std::string_view StandardStream = "-";
+
+    // In batch mode, arguments starting with this name a response file listing one input per line
+    constexpr char ResponseFilePrefix = '@';
+
     struct Options {
         std::string InputFile;
         std::string OutputFile;
+        OutputFormat::Format Format = OutputFormat::Format::Text;
+
+        // Inputs of batch mode as given, see ExpandBatchInputs. Each is assembled to its default output file
+        bool Batch = false;
+        std::vector<std::string> BatchInputs;
+        // How batch mode reads and writes files. io_uring falls back to blocking I/O where it is not available
+        IO::FileQueue::Backend IoBackend = IO::FileQueue::Backend::IoUring;
+
+        IO::Diagnostics::Format DiagnosticsFormat = IO::Diagnostics::Format::Text;
+        size_t MaxErrors = std::numeric_limits<size_t>::max();
+        bool Pipeline = false;
+        // Prints the time of every phase, throughput, symbol table and memory use to standard error
+        bool Stats = false;
+        // Writes a Chrome Trace Event file of what every thread did there, when not empty
+        std::string TraceFile;
+        // Threads to parse large inputs with, or to assemble the inputs of a batch with. 0 for one per core
+        size_t Jobs = 0;
 
         struct ParseError {
             enum Types : uint8_t {
                 MissingInput,
                 UnknownArgument,
                 TooManyArguments,
+                MissingValue,
+                InvalidValue,
+                IncompatibleOptions,
+                UnreadableInput,
             };
 
             Types Type;
@@ -22,24 +60,208 @@ namespace CLI {
         };
     };
 
+    std::string GetDefaultOutputFile(std::string_view inputFile, OutputFormat::Format format) {
+        size_t extensionStart = inputFile.find_last_of(".");
+        extensionStart = extensionStart == std::string::npos ? inputFile.length() : extensionStart;
+        return std::string(inputFile.substr(0, extensionStart)) + std::string(OutputFormat::GetExtension(format));
+    }
+
     std::expected<Options, Options::ParseError> ParseArguments(std::span<char*> arguments) {
-        switch (arguments.size()) {
-        case 1:
+        Options options;
+        std::vector<std::string_view> positionals;
+
+        for (size_t i = 1; i < arguments.size(); i++) {
+            std::string_view argument = arguments[i];
+
+            if (!argument.starts_with("--")) {
+                positionals.push_back(argument);
+                continue;
+            }
+
+            if (argument == "--pipeline") {
+                options.Pipeline = true;
+                continue;
+            }
+
+            if (argument == "--batch") {
+                options.Batch = true;
+                continue;
+            }
+
+            if (argument == "--stats") {
+                options.Stats = true;
+                continue;
+            }
+
+            if (argument != "--diagnostics" && argument != "--max-errors" && argument != "--jobs" && argument != "--io" && argument != "--format" && argument != "--trace") {
+                return std::unexpected<Options::ParseError>(std::in_place, Options::ParseError::UnknownArgument, "unknown argument");
+            }
+
+            if (++i == arguments.size()) {
+                return std::unexpected<Options::ParseError>(std::in_place, Options::ParseError::MissingValue, "missing value for option");
+            }
+
+            std::string_view value = arguments[i];
+            if (argument == "--diagnostics") {
+                if (value == "text") {
+                    options.DiagnosticsFormat = IO::Diagnostics::Format::Text;
+                }
+                else if (value == "json") {
+                    options.DiagnosticsFormat = IO::Diagnostics::Format::JsonLines;
+                }
+                else {
+                    return std::unexpected<Options::ParseError>(std::in_place, Options::ParseError::InvalidValue, "diagnostics format must be text or json");
+                }
+
+                continue;
+            }
+
+            if (argument == "--format") {
+                if (value == "text") {
+                    options.Format = OutputFormat::Format::Text;
+                }
+                else if (value == "raw") {
+                    options.Format = OutputFormat::Format::Raw;
+                }
+                else if (value == "image") {
+                    options.Format = OutputFormat::Format::Image;
+                }
+                else if (value == "hex") {
+                    options.Format = OutputFormat::Format::IntelHex;
+                }
+                else {
+                    return std::unexpected<Options::ParseError>(std::in_place, Options::ParseError::InvalidValue, "output format must be text, raw, image or hex");
+                }
+
+                continue;
+            }
+
+            if (argument == "--trace") {
+                options.TraceFile = value;
+                continue;
+            }
+
+            if (argument == "--io") {
+                if (value == "uring") {
+                    options.IoBackend = IO::FileQueue::Backend::IoUring;
+                }
+                else if (value == "blocking") {
+                    options.IoBackend = IO::FileQueue::Backend::Blocking;
+                }
+                else {
+                    return std::unexpected<Options::ParseError>(std::in_place, Options::ParseError::InvalidValue, "io backend must be uring or blocking");
+                }
+
+                continue;
+            }
+
+            const bool jobs = argument == "--jobs";
+            auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), jobs ? options.Jobs : options.MaxErrors);
+            if (error != std::errc() || end != value.data() + value.size()) {
+                return std::unexpected<Options::ParseError>(std::in_place, Options::ParseError::InvalidValue, jobs ? "jobs must be a non-negative integer" : "max errors must be a non-negative integer");
+            }
+        }
+
+        if (positionals.empty()) {
             return std::unexpected<Options::ParseError>(std::in_place, Options::ParseError::MissingInput, "missing input file");
-        case 2: {
-            std::string input = arguments[1];
-            size_t extensionStart = input.find_last_of(".");
-            extensionStart = extensionStart == std::string::npos ? input.length() : extensionStart;
-
-            return std::expected<Options, Options::ParseError>(std::in_place, input, input.substr(0, extensionStart) + ".hack"); }
-        case 3:
-            return std::expected<Options, Options::ParseError>(std::in_place, arguments[1], arguments[2]);
-        default:
+        }
+
+        if (options.Stats && (options.Batch || options.Pipeline)) {
+            return std::unexpected<Options::ParseError>(std::in_place, Options::ParseError::IncompatibleOptions, "statistics can not be combined with batch or pipeline mode");
+        }
+
+        if (options.Pipeline && options.Format != OutputFormat::Format::Text) {
+            return std::unexpected<Options::ParseError>(std::in_place, Options::ParseError::IncompatibleOptions, "pipeline mode only writes text");
+        }
+
+        if (options.Batch) {
+            if (options.Pipeline) {
+                return std::unexpected<Options::ParseError>(std::in_place, Options::ParseError::IncompatibleOptions, "batch mode can not be combined with pipeline mode");
+            }
+
+            if (std::ranges::find(positionals, StandardStream) != positionals.end()) {
+                return std::unexpected<Options::ParseError>(std::in_place, Options::ParseError::IncompatibleOptions, "batch mode can not read standard input");
+            }
+
+            options.BatchInputs.assign(positionals.begin(), positionals.end());
+            return options;
+        }
+
+        if (positionals.size() > 2) {
             return std::unexpected<Options::ParseError>(std::in_place, Options::ParseError::TooManyArguments, "too many arguments");
         }
+
+        options.InputFile = positionals[0];
+        if (positionals.size() == 2) {
+            options.OutputFile = positionals[1];
+        }
+        else if (options.InputFile == StandardStream) {
+            options.OutputFile = StandardStream;
+        }
+        else {
+            options.OutputFile = GetDefaultOutputFile(options.InputFile, options.Format);
+        }
+
+        // The pipeline patches forward references in place, after the rest of the output has been written
+        if (options.Pipeline && options.OutputFile == StandardStream) {
+            return std::unexpected<Options::ParseError>(std::in_place, Options::ParseError::IncompatibleOptions, "pipeline mode needs an output file");
+        }
+
+        return options;
+    }
+
+    // Replaces directories with the .asm files directly inside them, in name order, and response files with the inputs they list
+    std::expected<std::vector<std::string>, Options::ParseError> ExpandBatchInputs(std::span<const std::string> inputs) {
+        std::vector<std::string> result;
+        auto expand = [&](const std::string& input) {
+            std::error_code error;
+            if (!std::filesystem::is_directory(input, error)) {
+                result.push_back(input);
+                return true;
+            }
+
+            std::vector<std::string> files;
+            for (const auto& entry : std::filesystem::directory_iterator(input, error)) {
+                if (entry.path().extension() == ".asm" && !entry.is_directory(error)) {
+                    files.push_back(entry.path().string());
+                }
+            }
+
+            std::ranges::sort(files);
+            result.insert(result.end(), files.begin(), files.end());
+            return !error;
+        };
+
+        for (const std::string& input : inputs) {
+            if (!input.starts_with(ResponseFilePrefix)) {
+                if (!expand(input)) {
+                    return std::unexpected<Options::ParseError>(std::in_place, Options::ParseError::UnreadableInput, "could not list input directory");
+                }
+
+                continue;
+            }
+
+            std::ifstream responseFile(input.substr(1));
+            if (!responseFile.good()) {
+                return std::unexpected<Options::ParseError>(std::in_place, Options::ParseError::UnreadableInput, "could not read response file");
+            }
+
+            for (std::string line; std::getline(responseFile, line);) {
+                if (line.ends_with('\r')) {
+                    line.pop_back();
+                }
+
+                if (!line.empty() && !expand(line)) {
+                    return std::unexpected<Options::ParseError>(std::in_place, Options::ParseError::UnreadableInput, "could not list input directory");
+                }
+            }
+        }
+
+        return result;
     }
 
     std::string_view GetUsge() {
-        return "assembler <input_file> [output_file]";
+        return "assembler [--format text|raw|image|hex] [--diagnostics text|json] [--max-errors N] [--jobs N] [--trace file] [--pipeline | --stats] <input_file | -> [output_file | -]\n"
+               "       assembler --batch [--format text|raw|image|hex] [--diagnostics text|json] [--max-errors N] [--jobs N] [--trace file] [--io uring|blocking] <input_file | directory | @response_file>...";
     }
 }
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include "Diagnostics.h"
+
+#include <algorithm>
+#include <format>
+#include <charconv>
+#include <iterator>
+
+constexpr auto ANSI_COLOR_RESET= "\033[0m";
+constexpr auto ANSI_COLOR_RED = "\033[31m";
+constexpr auto ANSI_COLOR_CYAN = "\033[36m";
+constexpr auto ANSI_COLOR_GRAY = "\033[90m";
+
+static std::string TokenErrorMessage(SemanticToken::ParseError error, Lexer::TokenType type) {
+    switch (error) {
+        using enum SemanticToken::ParseError;
+    case Unexpected:
+        return std::format("Unexpected error parsing token of type {}", type.ToString());
+    case InvalidTokenType:
+        return std::format("Can not parse token of type {}", type.ToString());
+    case InvalidTokenData:
+        return std::format("Token is not a valid {}", type.ToString());
+    case IntegerOutOfRange:
+        return "Token was out of range for 16 bit unsigned integer";
+    }
+
+    return std::format("Unexpected error parsing token of type {}", type.ToString());
+}
+
+static std::string_view InstructionErrorMessage(Instructions::ParseError error) {
+    switch (error.Type) {
+        using enum Instructions::ParseError::Types;
+    case InvalidSemanticTokenType:
+        return "Expression could not be parsed as an addressing instruction. Not a valid variable name or integer constant";
+    case InvalidSemanticTokenCount:
+        return "Expression could not be parsed as a compute instruction. It contains too many tokens";
+    case InvalidOperationOrder:
+        return "Last token of compute instruction must be an operand (i.e. \"D\", \"M\", \"1\") or a jump mnemonic (i.e. \"JMP\", \"JGT\").";
+    case MissingOperation:
+        return "Expected the assignment operator (\"=\"), the jump operator (\";\") or an comparison operator (i.e. \"+\", \"!\", \"&\").";
+    case MissingOperand:
+        return "Expected an operand (i.e. \"D\", \"M\", \"1\").";
+    case InvalidAssignmentOrder:
+        return "Only a destination mnemonic (i.e. \"A\", \"D\", \"ADM\") may appear before the assignment operator (\"=\").";
+    case InvalidDestination:
+        return "Not a valid destination for assignment (i.e. \"A\", \"D\", \"ADM\").";
+    case InvalidOperand:
+        return "Not a valid operand (\"A\", \"D\", \"M\", \"0\", \"1\" or \"-1\").";
+    case InvalidJumpOrder:
+        return "Only a jump mnemonic (i.e. \"JMP\", \"JGT\") may appear after the jump operator (\";\").";
+    case InvalidJump:
+        return "Not a valid jump mnemonic (i.e. \"JMP\", \"JGT\").";
+    case MissingEffect:
+        return "Compute instruction must contain an assignment or a jump.";
+    case InvalidRegisterOperandOrder:
+        return "Register D may not appear on the right side of the addition (\"+\"), bitwise and (\"&\"), and bitwise or (\"|\") operators";
+    case InvalidRegisterOperands:
+        return "Compute instruction comparison may not use both A and M registers";
+    case InvalidNumericOperand:
+        return "A numeric operand may not appear on the left side of an comparison operator (i.e. \"+\", \"!\", \"&\").";
+    case InvalidOneOperand:
+        return "The one operand may not be used with the negation (\"!\"), bitwise and (\"&\"), and bitwise or (\"|\") operators";
+    case InvalidZeroOperand:
+        return "The zero operand may only appear after the assignment operator (\"=\") or before the jump operator (\";\")";
+    }
+
+    return "Unexpected error parsing expression";
+}
+
+// Tab stops are counted from the start of each appended part. Returns the number of characters appended
+static size_t AppendRemovingTabs(std::string& buffer, std::string_view chars) {
+    size_t start = buffer.size();
+
+    for (size_t i = 0; i < chars.size(); i++) {
+        if (chars[i] != '\t') {
+            buffer.push_back(chars[i]);
+            continue;
+        }
+
+        buffer.append(4 - i % 4, ' ');
+    }
+    return buffer.size() - start;
+}
+
+static void AppendNumber(std::string& buffer, size_t number) {
+    char digits[std::numeric_limits<size_t>::digits10 + 1];
+    auto [end, error] = std::to_chars(std::begin(digits), std::end(digits), number);
+    buffer.append(digits, end);
+}
+
+static constexpr bool NeedsJsonEscape(char character) {
+    return character == '"' || character == '\\' || static_cast<unsigned char>(character) < 0x20;
+}
+
+static void AppendJsonString(std::string& buffer, std::string_view text) {
+    buffer.push_back('"');
+    while (!text.empty()) {
+        size_t run = std::find_if(text.begin(), text.end(), NeedsJsonEscape) - text.begin();
+        buffer.append(text.substr(0, run));
+        if (run == text.size()) {
+            break;
+        }
+
+        switch (char character = text[run]) {
+        case '"':  buffer.append("\\\""); break;
+        case '\\': buffer.append("\\\\"); break;
+        case '\t': buffer.append("\\t"); break;
+        case '\r': buffer.append("\\r"); break;
+        case '\n': buffer.append("\\n"); break;
+        default:
+            buffer.append("\\u00");
+            buffer.push_back("0123456789abcdef"[character >> 4]);
+            buffer.push_back("0123456789abcdef"[character & 15]);
+        }
+
+        text.remove_prefix(run + 1);
+    }
+    buffer.push_back('"');
+}
+
+void IO::Diagnostics::Error(Instructions::ParseError error, const StreamState& info) {
+    Record(InstructionErrorMessage(error), info.ExpressionOffset, info, true);
+}
+
+void IO::Diagnostics::Error(SemanticToken::ParseError error, Lexer::TokenType tokenType, const StreamState& info) {
+    if (m_ErrorCount >= m_MaxErrors) {
+        m_ErrorCount++;
+        return;
+    }
+
+    Record(TokenErrorMessage(error, tokenType), info.ExpressionOffset, info, false);
+}
+
+void IO::Diagnostics::Error(std::string_view message, size_t characterNumber, const StreamState& info) {
+    Record(message, characterNumber, info, true);
+}
+
+void IO::Diagnostics::Flush(std::ostream& out) {
+    if (m_ErrorCount > m_MaxErrors && m_Format == Format::Text) {
+        std::format_to(std::back_inserter(m_Buffer), "{}: {} more errors were not shown\n", m_StreamName, m_ErrorCount - m_MaxErrors);
+    }
+
+    out.write(m_Buffer.data(), static_cast<std::streamsize>(m_Buffer.size()));
+    out.flush();
+    m_Buffer.clear();
+    m_Entries.clear();
+}
+
+void IO::Diagnostics::Append(const Diagnostics& first, const Diagnostics& second) {
+    size_t firstIndex = 0;
+    size_t secondIndex = 0;
+    while (firstIndex < first.m_Entries.size() || secondIndex < second.m_Entries.size()) {
+        const bool fromFirst = secondIndex == second.m_Entries.size()
+            || (firstIndex < first.m_Entries.size() && first.m_Entries[firstIndex].Position <= second.m_Entries[secondIndex].Position);
+        const Diagnostics& from = fromFirst ? first : second;
+        size_t& index = fromFirst ? firstIndex : secondIndex;
+
+        if (m_ErrorCount++ < m_MaxErrors) {
+            size_t start = index == 0 ? 0 : from.m_Entries[index - 1].End;
+            m_Buffer.append(from.m_Buffer, start, from.m_Entries[index].End - start);
+            m_Entries.push_back(Entry{ from.m_Entries[index].Position, m_Buffer.size() });
+        }
+
+        index++;
+    }
+
+    // Errors past the cap of either were never formatted, and come after all of the ones that were
+    m_ErrorCount += first.m_ErrorCount - first.m_Entries.size() + second.m_ErrorCount - second.m_Entries.size();
+}
+
+void IO::Diagnostics::Record(std::string_view message, size_t characterNumber, const StreamState& info, bool markToken) {
+    if (m_ErrorCount++ >= m_MaxErrors) {
+        return;
+    }
+
+    std::string_view line = GetLine(info);
+    if (m_Format == Format::JsonLines) {
+        JsonError(message, characterNumber, line, info, markToken);
+        m_Entries.push_back(Entry{ info.Position, m_Buffer.size() });
+        return;
+    }
+
+    m_Buffer.append(m_StreamName).append(":").append(ANSI_COLOR_CYAN);
+    AppendNumber(m_Buffer, info.LineNumber);
+    m_Buffer.append(ANSI_COLOR_RESET).append(":").append(ANSI_COLOR_CYAN);
+    AppendNumber(m_Buffer, characterNumber);
+    m_Buffer.append(ANSI_COLOR_RESET).append(" ").append(message).append("\n");
+
+    if (markToken) {
+        TextErrorLine(line, info);
+    }
+    else {
+        TextErrorLineSimple(line, info);
+    }
+
+    m_Entries.push_back(Entry{ info.Position, m_Buffer.size() });
+}
+
+std::string_view IO::Diagnostics::GetLine(const StreamState& info) {
+    if (!m_LineIndex.has_value() || m_LineIndex.value().Source().data() != info.Stream.data() || m_LineIndex.value().Source().size() != info.Stream.size()) {
+        m_LineIndex.emplace(info.Stream);
+    }
+
+    return m_LineIndex.value().GetLine(info.Position - std::min(info.LineLength, info.Position), info.LineNumber);
+}
+
+void IO::Diagnostics::TextErrorLine(std::string_view line, const StreamState& info) {
+    if (info.TokenOffset == (size_t)-1 ||  info.TokenLength == info.ExpressionLength) {
+        TextErrorLineSimple(line, info);
+        return;
+    }
+    
+    assert(info.TokenLength < info.ExpressionLength);
+    assert(info.TokenOffset >= info.ExpressionOffset);
+
+    size_t before = AppendRemovingTabs(m_Buffer, line.substr(0, info.ExpressionOffset));
+    size_t expression = AppendRemovingTabs(m_Buffer, line.substr(info.ExpressionOffset, info.TokenOffset - info.ExpressionOffset));
+    size_t after = AppendRemovingTabs(m_Buffer, line.substr(info.TokenOffset, info.ExpressionOffset + info.ExpressionLength - info.TokenOffset));
+    m_Buffer.append(line.substr(info.ExpressionOffset + info.ExpressionLength)).append("\n");
+
+    m_Buffer.append(before, ' ').append(ANSI_COLOR_GRAY).append(expression + after, '~').append("\033[");
+    AppendNumber(m_Buffer, after);
+    m_Buffer.append("D").append(ANSI_COLOR_RED).append(info.TokenLength, '~').append(ANSI_COLOR_RESET).append("\n");
+}
+
+void IO::Diagnostics::TextErrorLineSimple(std::string_view line, const StreamState& info) {
+    size_t before = AppendRemovingTabs(m_Buffer, line.substr(0, info.ExpressionOffset));
+    size_t expression = AppendRemovingTabs(m_Buffer, line.substr(info.ExpressionOffset, info.ExpressionLength));
+    m_Buffer.append(line.substr(info.ExpressionOffset + info.ExpressionLength)).append("\n");
+
+    m_Buffer.append(before, ' ').append(ANSI_COLOR_RED).append(expression, '~').append(ANSI_COLOR_RESET).append("\n");
+}
+
+void IO::Diagnostics::JsonError(std::string_view message, size_t characterNumber, std::string_view line, const StreamState& info, bool markToken) {
+    m_Buffer.append("{\"file\":");
+    AppendJsonString(m_Buffer, m_StreamName);
+    m_Buffer.append(",\"line\":");
+    AppendNumber(m_Buffer, info.LineNumber);
+    m_Buffer.append(",\"column\":");
+    AppendNumber(m_Buffer, characterNumber);
+    m_Buffer.append(",\"message\":");
+    AppendJsonString(m_Buffer, message);
+    m_Buffer.append(",\"source\":");
+    AppendJsonString(m_Buffer, line);
+    m_Buffer.append(",\"expression\":{\"offset\":");
+    AppendNumber(m_Buffer, info.ExpressionOffset);
+    m_Buffer.append(",\"length\":");
+    AppendNumber(m_Buffer, info.ExpressionLength);
+    m_Buffer.append("}");
+    
+    if (markToken && info.TokenOffset != (size_t)-1) {
+        m_Buffer.append(",\"token\":{\"offset\":");
+        AppendNumber(m_Buffer, info.TokenOffset);
+        m_Buffer.append(",\"length\":");
+        AppendNumber(m_Buffer, info.TokenLength);
+        m_Buffer.append("}");
+    }
+
+    m_Buffer.append("}\n");
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "LineIndex.h"
+
+#include "Assembler/Lexer.h"
+#include "Assembler/SemanticToken.h"
+#include "Assembler/Instructions.h"
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <vector>
+#include <ostream>
+#include <limits>
+#include <cstdint>
+
+namespace IO {
+    // Collects the diagnostics of one input in memory and writes them out with a single call to Flush.
+    // Errors past the cap are still counted, but never formatted.
+    class Diagnostics {
+    public:
+        enum class Format : uint8_t {
+            Text,
+            JsonLines,
+        };
+
+        struct StreamState {
+            std::string_view Stream;
+            size_t Position = 0;
+
+            size_t LineNumber = 1;
+            size_t LineLength = 0;
+            size_t ExpressionOffset = (size_t)-1;
+            size_t ExpressionLength = 0;
+            
+            size_t TokenOffset = (size_t)-1;
+            size_t TokenLength = 0;
+            
+            StreamState(std::string_view stream) : Stream(stream) {}
+            StreamState(std::string_view stream, size_t position, size_t lineNumber, size_t lineLength, size_t expressionOffset, size_t expressionLength)
+                : Stream(stream), Position(position), LineNumber(lineNumber), LineLength(lineLength), ExpressionOffset(expressionOffset), ExpressionLength(expressionLength) {}
+        };
+
+        Diagnostics(std::string streamName, Format format = Format::Text, size_t maxErrors = std::numeric_limits<size_t>::max())
+            : m_StreamName(std::move(streamName)), m_Format(format), m_MaxErrors(maxErrors) {}
+
+        void Error(Instructions::ParseError error, const StreamState& info);
+        void Error(SemanticToken::ParseError error, Lexer::TokenType tokenType, const StreamState& info);
+        void Error(std::string_view message, size_t characterNumber, const StreamState& info);
+
+        inline size_t ErrorCount() const { return m_ErrorCount; }
+
+        // An empty collector with the same settings, for diagnostics gathered on another thread and merged back with Append
+        inline Diagnostics Child() const { return Diagnostics(m_StreamName, m_Format, m_MaxErrors); }
+        // Appends the errors of both, which must each be in source order, merged by position. On equal positions first goes first
+        void Append(const Diagnostics& first, const Diagnostics& second);
+
+        void Flush(std::ostream& out);
+    private:
+        struct Entry {
+            size_t Position;
+            size_t End;
+        };
+
+        void Record(std::string_view message, size_t characterNumber, const StreamState& info, bool markToken);
+        std::string_view GetLine(const StreamState& info);
+
+        void TextErrorLine(std::string_view line, const StreamState& info);
+        void TextErrorLineSimple(std::string_view line, const StreamState& info);
+        void JsonError(std::string_view message, size_t characterNumber, std::string_view line, const StreamState& info, bool markToken);
+
+        std::string m_StreamName;
+        Format m_Format;
+        size_t m_MaxErrors;
+        size_t m_ErrorCount = 0;
+
+        std::string m_Buffer;
+        // Where each formatted error ends in the buffer
+        std::vector<Entry> m_Entries;
+        // Built on the first diagnostic, valid input never pays for it
+        std::optional<LineIndex> m_LineIndex;
+    };
+}
\ No newline at end of file
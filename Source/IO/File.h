@@ -1,24 +1,45 @@
 #pragma once
 
+#include "MappedFile.h"
+#include "MappedOutput.h"
+
 #include <fstream>
 #include <optional>
 #include <filesystem>
 
+#ifdef _WIN32
+    #include <io.h>
+    #include <fcntl.h>
+    #include <cstdio>
+#endif
+
 namespace IO {
-    [[nodiscard]] std::optional<std::ifstream> TryOpenFileInput(const std::string& fileName) {
-        std::ifstream file;
-        file.open(fileName);
-        
-        return file.good() ? std::optional<std::ifstream>(std::move(file)) : std::optional<std::ifstream>(std::nullopt);
+    [[nodiscard]] std::optional<MappedFile> TryOpenFileInput(const std::string& fileName) {
+        return MappedFile::TryOpen(fileName);
+    }
+
+    [[nodiscard]] std::optional<MappedFile> TryOpenStandardInput() {
+        return MappedFile::TryOpenStandardInput();
     }
     
-    [[nodiscard]] std::optional<std::ofstream> TryOpenFileOutput(const std::string& fileName) {
+    [[nodiscard]] std::optional<std::ofstream> TryOpenFileOutput(const std::string& fileName, std::ios::openmode mode = std::ios::out) {
         std::ofstream file;
-        file.open(fileName);
+        file.open(fileName, mode);
         
         return file.good() ? std::optional<std::ofstream>(std::move(file)) : std::optional<std::ofstream>(std::nullopt);
     }
 
+    [[nodiscard]] std::optional<MappedOutput> TryOpenMappedOutput(const std::string& fileName) {
+        return MappedOutput::TryOpen(fileName);
+    }
+
+    // Every output format writes its own line endings, standard output must not translate them
+    void SetStandardOutputBinary() {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    }
+
     [[nodiscard]] std::string GetAblsolutePath(std::string_view path) {
         return std::filesystem::absolute(path).string();
     }
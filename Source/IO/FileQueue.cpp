@@ -0,0 +1,530 @@
+#include "FileQueue.h"
+
+#include "Assembler/Trace.h"
+
+#include <fstream>
+#include <deque>
+#include <algorithm>
+#include <utility>
+
+#ifdef __linux__
+    #include <linux/io_uring.h>
+    #include <sys/syscall.h>
+    #include <sys/mman.h>
+    #include <sys/eventfd.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+
+    #include <atomic>
+    #include <cerrno>
+    #include <cstring>
+#endif
+
+// One whole-file read or write. With io_uring it is submitted as a linked open, read or write, and close of a
+// registered file slot, repeated from where the last one ended until the whole file is transferred. Reads get the
+// size of the file first, anything but a regular file is loaded by the caller instead
+struct IO::FileQueue::Operation {
+    bool Write = false;
+    bool Failed = false;
+    bool Blocking = false;
+
+    size_t Index = 0;
+    std::string Path;
+    std::string Data;
+    size_t Done = 0;
+
+#ifdef __linux__
+    static constexpr uint64_t StepMask = 3;
+
+    enum Steps : uint64_t {
+        Open,
+        Transfer,
+        Close,
+        Stat,
+    };
+
+    unsigned Slot = 0;
+    unsigned PendingSteps = 0;
+    int StatResult = 0;
+    int OpenResult = 0;
+    int TransferResult = 0;
+    struct statx Status {};
+    // Of a read, once it is known
+    std::optional<size_t> Size;
+
+    void Prepare(io_uring_sqe& entry, Steps step);
+    // Called once every step of the chain completed. Returns whether there is another chain to submit
+    bool Advance();
+#endif
+};
+
+#ifdef __linux__
+
+// io_uring through raw system calls. Only the I/O thread touches the queues, other threads wake it through the doorbell eventfd
+class IO::FileQueue::Ring {
+public:
+    ~Ring();
+
+    static std::unique_ptr<Ring> TryCreate(unsigned entries, unsigned fileSlots);
+
+    inline unsigned GetFreeEntries() const { return m_Entries - (m_LocalTail - std::atomic_ref<uint32_t>(*m_SqHead).load(std::memory_order_acquire)); }
+
+    // Returns a cleared submission entry, or nullptr if all of them are queued
+    io_uring_sqe* TryGetEntry();
+    // Submits the entries queued since the last call and waits for at least one completion
+    void SubmitAndWait();
+
+    template <typename F>
+    void ForEachCompletion(F&& function) {
+        uint32_t head = *m_CqHead;
+        const uint32_t tail = std::atomic_ref<uint32_t>(*m_CqTail).load(std::memory_order_acquire);
+        for (; head != tail; head++) {
+            const io_uring_cqe& completion = m_Cqes[head & m_CqMask];
+            function(completion.user_data, completion.res);
+        }
+
+        std::atomic_ref<uint32_t>(*m_CqHead).store(head, std::memory_order_release);
+    }
+
+    // Completes with user data 0 the next time Notify is called
+    void PrepareDoorbell(io_uring_sqe& entry);
+    void Notify();
+private:
+    Ring() = default;
+
+    int m_File = -1;
+    int m_Doorbell = -1;
+    uint64_t m_DoorbellValue = 0;
+
+    void* m_SqRing = MAP_FAILED;
+    size_t m_SqRingSize = 0;
+    void* m_CqRing = MAP_FAILED;
+    size_t m_CqRingSize = 0;
+    io_uring_sqe* m_Sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    unsigned m_Entries = 0;
+
+    uint32_t* m_SqHead = nullptr;
+    uint32_t* m_SqTail = nullptr;
+    uint32_t* m_SqArray = nullptr;
+    uint32_t m_SqMask = 0;
+    uint32_t m_LocalTail = 0;
+
+    uint32_t* m_CqHead = nullptr;
+    uint32_t* m_CqTail = nullptr;
+    io_uring_cqe* m_Cqes = nullptr;
+    uint32_t m_CqMask = 0;
+};
+
+// Every operation in flight has a chain of three entries and a file slot
+static constexpr unsigned RingEntries = 96;
+static constexpr unsigned FileSlots = RingEntries / 3;
+static constexpr size_t MaxTransfer = 1 << 30;
+
+IO::FileQueue::Ring::~Ring() {
+    if (m_Sqes != MAP_FAILED) { munmap(m_Sqes, m_Entries * sizeof(io_uring_sqe)); }
+    if (m_CqRing != MAP_FAILED && m_CqRing != m_SqRing) { munmap(m_CqRing, m_CqRingSize); }
+    if (m_SqRing != MAP_FAILED) { munmap(m_SqRing, m_SqRingSize); }
+    if (m_Doorbell >= 0) { close(m_Doorbell); }
+    if (m_File >= 0) { close(m_File); }
+}
+
+std::unique_ptr<IO::FileQueue::Ring> IO::FileQueue::Ring::TryCreate(unsigned entries, unsigned fileSlots) {
+    io_uring_params params{};
+    std::unique_ptr<Ring> ring(new Ring());
+    ring->m_File = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring->m_File < 0) {
+        return nullptr;
+    }
+
+    // Every operation used has to be supported, older kernels only have some of them
+    constexpr size_t ProbeOps = 256;
+    std::vector<uint8_t> probeBuffer(sizeof(io_uring_probe) + ProbeOps * sizeof(io_uring_probe_op));
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probeBuffer.data());
+    if (syscall(__NR_io_uring_register, ring->m_File, IORING_REGISTER_PROBE, probe, ProbeOps) < 0) {
+        return nullptr;
+    }
+
+    for (uint8_t operation : { IORING_OP_STATX, IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_CLOSE }) {
+        if (operation > probe->last_op || !(probe->ops[operation].flags & IO_URING_OP_SUPPORTED)) {
+            return nullptr;
+        }
+    }
+
+    const bool singleMapping = params.features & IORING_FEAT_SINGLE_MMAP;
+    ring->m_SqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    ring->m_CqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (singleMapping) {
+        ring->m_SqRingSize = ring->m_CqRingSize = std::max(ring->m_SqRingSize, ring->m_CqRingSize);
+    }
+
+    ring->m_SqRing = mmap(nullptr, ring->m_SqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->m_File, IORING_OFF_SQ_RING);
+    ring->m_CqRing = singleMapping ? ring->m_SqRing : mmap(nullptr, ring->m_CqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->m_File, IORING_OFF_CQ_RING);
+    ring->m_Entries = params.sq_entries;
+    ring->m_Sqes = static_cast<io_uring_sqe*>(mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->m_File, IORING_OFF_SQES));
+    if (ring->m_SqRing == MAP_FAILED || ring->m_CqRing == MAP_FAILED || ring->m_Sqes == MAP_FAILED) {
+        return nullptr;
+    }
+
+    char* sq = static_cast<char*>(ring->m_SqRing);
+    ring->m_SqHead = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+    ring->m_SqTail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+    ring->m_SqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+    ring->m_SqMask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+    ring->m_LocalTail = *ring->m_SqTail;
+
+    char* cq = static_cast<char*>(ring->m_CqRing);
+    ring->m_CqHead = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+    ring->m_CqTail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+    ring->m_Cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    ring->m_CqMask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+
+    // Sparse registration needs Linux 5.19, which also has every direct descriptor operation used
+    io_uring_rsrc_register slots{};
+    slots.nr = fileSlots;
+    slots.flags = IORING_RSRC_REGISTER_SPARSE;
+    if (syscall(__NR_io_uring_register, ring->m_File, IORING_REGISTER_FILES2, &slots, sizeof(slots)) < 0) {
+        return nullptr;
+    }
+
+    ring->m_Doorbell = eventfd(0, EFD_CLOEXEC);
+    if (ring->m_Doorbell < 0) {
+        return nullptr;
+    }
+
+    return ring;
+}
+
+io_uring_sqe* IO::FileQueue::Ring::TryGetEntry() {
+    if (m_LocalTail - std::atomic_ref<uint32_t>(*m_SqHead).load(std::memory_order_acquire) == m_Entries) {
+        return nullptr;
+    }
+
+    const uint32_t index = m_LocalTail++ & m_SqMask;
+    m_SqArray[index] = index;
+    std::memset(&m_Sqes[index], 0, sizeof(io_uring_sqe));
+    return &m_Sqes[index];
+}
+
+void IO::FileQueue::Ring::SubmitAndWait() {
+    std::atomic_ref<uint32_t>(*m_SqTail).store(m_LocalTail, std::memory_order_release);
+
+    for (;;) {
+        const uint32_t queued = m_LocalTail - std::atomic_ref<uint32_t>(*m_SqHead).load(std::memory_order_acquire);
+        if (syscall(__NR_io_uring_enter, m_File, queued, 1, IORING_ENTER_GETEVENTS, nullptr, 0) >= 0) {
+            return;
+        }
+
+        // Interrupted, or out of kernel resources until some completions are reaped, which waiting does
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            return;
+        }
+    }
+}
+
+void IO::FileQueue::Ring::PrepareDoorbell(io_uring_sqe& entry) {
+    entry.opcode = IORING_OP_READ;
+    entry.fd = m_Doorbell;
+    entry.addr = reinterpret_cast<uint64_t>(&m_DoorbellValue);
+    entry.len = sizeof(m_DoorbellValue);
+    entry.user_data = 0;
+}
+
+void IO::FileQueue::Ring::Notify() {
+    const uint64_t value = 1;
+    [[maybe_unused]] ssize_t written = write(m_Doorbell, &value, sizeof(value));
+}
+
+void IO::FileQueue::Operation::Prepare(io_uring_sqe& entry, Steps step) {
+    entry.user_data = reinterpret_cast<uint64_t>(this) | step;
+
+    switch (step) {
+    case Stat:
+        entry.opcode = IORING_OP_STATX;
+        entry.fd = AT_FDCWD;
+        entry.addr = reinterpret_cast<uint64_t>(Path.c_str());
+        entry.len = STATX_TYPE | STATX_SIZE;
+        entry.off = reinterpret_cast<uint64_t>(&Status);
+        break;
+    case Open:
+        entry.opcode = IORING_OP_OPENAT;
+        entry.fd = AT_FDCWD;
+        entry.addr = reinterpret_cast<uint64_t>(Path.c_str());
+        // Direct descriptors are never inherited, the kernel rejects O_CLOEXEC for them
+        entry.open_flags = Write ? O_WRONLY | O_CREAT | (Done == 0 ? O_TRUNC : 0) : O_RDONLY;
+        entry.len = Write ? 0666 : 0;
+        entry.file_index = Slot + 1;
+        entry.flags = IOSQE_IO_LINK;
+        break;
+    case Transfer:
+        entry.opcode = Write ? IORING_OP_WRITE : IORING_OP_READ;
+        entry.fd = static_cast<int>(Slot);
+        entry.addr = reinterpret_cast<uint64_t>(Data.data() + Done);
+        entry.len = static_cast<uint32_t>(std::min(Data.size() - Done, MaxTransfer));
+        entry.off = Done;
+        // A short transfer breaks a normal link, the slot has to be closed anyway
+        entry.flags = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+        break;
+    case Close:
+        entry.opcode = IORING_OP_CLOSE;
+        entry.file_index = Slot + 1;
+        break;
+    }
+}
+
+bool IO::FileQueue::Operation::Advance() {
+    if (!Write && !Size.has_value()) {
+        // Pipes and devices cannot be opened again for every chain
+        Failed = StatResult < 0;
+        Blocking = !Failed && !S_ISREG(Status.stx_mode);
+        Size = Failed || Blocking ? 0 : Status.stx_size;
+        Data.resize(Size.value());
+        return !Data.empty();
+    }
+
+    if (OpenResult < 0 || TransferResult < 0) {
+        Failed = true;
+        return false;
+    }
+
+    Done += static_cast<size_t>(TransferResult);
+    if (Write) {
+        // Writing nothing of what is left would never finish
+        Failed = Done < Data.size() && TransferResult == 0;
+        return Done < Data.size() && !Failed;
+    }
+
+    // Reads end short of what was asked for past 1 GiB, or at the end of a file that shrank since it was stat'ed
+    if (TransferResult == 0) {
+        Data.resize(Done);
+    }
+
+    return Done < Data.size();
+}
+
+void IO::FileQueue::Run() {
+    Ring& ring = *m_Ring;
+
+    // Operations waiting for a file slot, or for entries to submit their chain to. 
+    // While in flight, operations are owned by the user data of their entries
+    std::deque<std::unique_ptr<Operation>> ready;
+    std::vector<unsigned> freeSlots;
+    for (unsigned slot = FileSlots; slot-- > 0;) {
+        freeSlots.push_back(slot);
+    }
+
+    size_t live = 0;
+    bool doorbellArmed = false;
+
+    for (;;) {
+        bool stop = false;
+        {
+            std::lock_guard lock(m_Mutex);
+            for (; !m_Stop && m_NextRead < m_Inputs.size() && m_NextRead < m_NextTake + m_ReadAhead; m_NextRead++) {
+                auto operation = std::make_unique<Operation>();
+                operation->Index = m_NextRead;
+                operation->Path = m_Inputs[m_NextRead];
+                ready.push_back(std::move(operation));
+                live++;
+            }
+
+            live += m_NewWrites.size();
+            std::ranges::move(m_NewWrites, std::back_inserter(ready));
+            m_NewWrites.clear();
+            stop = m_Stop;
+        }
+
+        if (stop && live == 0) {
+            return;
+        }
+
+        // The doorbell entry is not counted against the slots, there is always room for it once the ring is drained
+        if (!doorbellArmed) {
+            if (io_uring_sqe* entry = ring.TryGetEntry()) {
+                ring.PrepareDoorbell(*entry);
+                doorbellArmed = true;
+            }
+        }
+
+        while (!ready.empty() && ring.GetFreeEntries() >= 3) {
+            Operation* operation = ready.front().get();
+            if (!operation->Write && !operation->Size.has_value()) {
+                operation->PendingSteps = 1;
+                operation->Prepare(*ring.TryGetEntry(), Operation::Stat);
+            }
+            else if (!freeSlots.empty()) {
+                io_uring_sqe* open = ring.TryGetEntry();
+                io_uring_sqe* transfer = ring.TryGetEntry();
+                io_uring_sqe* close = ring.TryGetEntry();
+
+                operation->Slot = freeSlots.back();
+                freeSlots.pop_back();
+                operation->PendingSteps = 3;
+                operation->Prepare(*open, Operation::Open);
+                operation->Prepare(*transfer, Operation::Transfer);
+                operation->Prepare(*close, Operation::Close);
+            }
+            else {
+                break;
+            }
+
+            ready.front().release();
+            ready.pop_front();
+        }
+
+        ring.SubmitAndWait();
+        ring.ForEachCompletion([&](uint64_t userData, int result) {
+            if (userData == 0) {
+                doorbellArmed = false;
+                return;
+            }
+
+            Operation* operation = reinterpret_cast<Operation*>(userData & ~Operation::StepMask);
+            switch (userData & Operation::StepMask) {
+            case Operation::Open: operation->OpenResult = result; break;
+            case Operation::Transfer: operation->TransferResult = result; break;
+            case Operation::Stat: operation->StatResult = result; break;
+            default: break;
+            }
+
+            if (--operation->PendingSteps != 0) {
+                return;
+            }
+
+            // Stats are submitted without a slot
+            if (operation->Write || operation->Size.has_value()) {
+                freeSlots.push_back(operation->Slot);
+            }
+
+            std::unique_ptr<Operation> owned(operation);
+            if (owned->Advance()) {
+                ready.push_back(std::move(owned));
+                return;
+            }
+
+            Complete(std::move(owned));
+            live--;
+        });
+    }
+}
+
+#else
+
+class IO::FileQueue::Ring {
+public:
+    void Notify() {}
+};
+
+#endif
+
+
+IO::FileQueue::FileQueue(std::vector<std::string> inputs, [[maybe_unused]] Backend preferred, size_t readAhead)
+    : m_Inputs(std::move(inputs)), m_ReadAhead(std::max<size_t>(readAhead, 1)), m_Read(m_Inputs.size()) {
+#ifdef __linux__
+    if (preferred == Backend::IoUring) {
+        m_Ring = Ring::TryCreate(RingEntries + 1, FileSlots);
+    }
+
+    if (m_Ring) {
+        m_Thread = std::thread(&FileQueue::Run, this);
+    }
+#endif
+}
+
+IO::FileQueue::~FileQueue() {
+    if (!m_Thread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Stop = true;
+    }
+
+    m_Ring->Notify();
+    m_Thread.join();
+}
+
+std::optional<IO::FileQueue::Input> IO::FileQueue::TakeNext() {
+    Trace::Zone zone("take input");
+    std::unique_lock lock(m_Mutex);
+    if (m_NextTake == m_Inputs.size()) {
+        return std::nullopt;
+    }
+
+    const size_t index = m_NextTake++;
+    if (!m_Ring) {
+        lock.unlock();
+        return Input{ index, m_Inputs[index], MappedFile::TryOpen(m_Inputs[index]) };
+    }
+
+    // Reads are submitted half a window at a time
+    if (m_NextRead < m_Inputs.size() && m_NextRead + m_ReadAhead / 2 < m_NextTake + m_ReadAhead) {
+        m_Ring->Notify();
+    }
+
+    m_Changed.wait(lock, [&] { return m_Read[index].Done; });
+    if (m_Read[index].Blocking) {
+        lock.unlock();
+        return Input{ index, m_Inputs[index], MappedFile::TryOpen(m_Inputs[index]) };
+    }
+
+    return Input{ index, m_Inputs[index], std::exchange(m_Read[index].File, std::nullopt) };
+}
+
+void IO::FileQueue::Write(std::string path, std::string data) {
+    Trace::Zone zone("write output");
+    if (!m_Ring) {
+        std::ofstream file(path, std::ios::out | std::ios::binary);
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        file.close();
+
+        if (!file.good()) {
+            std::lock_guard lock(m_Mutex);
+            m_FailedWrites.push_back(std::move(path));
+        }
+
+        return;
+    }
+
+    auto operation = std::make_unique<Operation>();
+    operation->Write = true;
+    operation->Path = std::move(path);
+    operation->Data = std::move(data);
+
+    std::lock_guard lock(m_Mutex);
+    m_NewWrites.push_back(std::move(operation));
+    m_PendingWrites++;
+
+    // The I/O thread takes all new writes at once, it only has to be woken for the first
+    if (m_NewWrites.size() == 1) {
+        m_Ring->Notify();
+    }
+}
+
+std::vector<std::string> IO::FileQueue::Flush() {
+    std::unique_lock lock(m_Mutex);
+    m_Changed.wait(lock, [&] { return m_PendingWrites == 0; });
+    return std::exchange(m_FailedWrites, {});
+}
+
+void IO::FileQueue::Complete(std::unique_ptr<Operation> operation) {
+    std::lock_guard lock(m_Mutex);
+    if (operation->Write) {
+        if (operation->Failed) {
+            m_FailedWrites.push_back(std::move(operation->Path));
+        }
+
+        m_PendingWrites--;
+    }
+    else {
+        ReadSlot& slot = m_Read[operation->Index];
+        slot.Done = true;
+        slot.Blocking = operation->Blocking;
+        if (!operation->Failed && !operation->Blocking) {
+            slot.File.emplace(std::move(operation->Data));
+        }
+    }
+
+    m_Changed.notify_all();
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <optional>
+#include <thread>
+#include <cstdint>
+
+namespace IO {
+    // Reads the inputs and writes the outputs of a batch. With io_uring, the reads of the next inputs and the writes 
+    // of finished outputs are submitted in batches and run in the kernel, driven by one I/O thread, while the caller 
+    // assembles. The blocking backend reads and writes on the calling thread, and is used wherever io_uring is not available.
+    class FileQueue {
+    public:
+        enum class Backend : uint8_t {
+            Blocking,
+            IoUring,
+        };
+
+        struct Input {
+            size_t Index;
+            std::string Path;
+            // Empty if the file could not be read
+            std::optional<MappedFile> File;
+        };
+
+        // Falls back to the blocking backend if io_uring is preferred but not supported by the platform or kernel
+        FileQueue(std::vector<std::string> inputs, Backend preferred, size_t readAhead = 32);
+        // Waits for the reads and writes still in flight
+        ~FileQueue();
+
+        FileQueue(const FileQueue&) = delete;
+        FileQueue& operator=(const FileQueue&) = delete;
+
+        inline Backend GetBackend() const { return m_Ring ? Backend::IoUring : Backend::Blocking; }
+
+        // Returns the next input in order, blocking until it is read, or nothing once every input has been taken. Thread safe
+        std::optional<Input> TakeNext();
+        // Replaces the contents of path with data. Thread safe, only blocks with the blocking backend
+        void Write(std::string path, std::string data);
+        // Waits for every write so far. Returns the paths that could not be written since the last call
+        std::vector<std::string> Flush();
+    private:
+        class Ring;
+        struct Operation;
+
+        struct ReadSlot {
+            bool Done = false;
+            // Not a regular file, loaded by the caller
+            bool Blocking = false;
+            std::optional<MappedFile> File;
+        };
+
+        // The I/O thread of the io_uring backend
+        void Run();
+        void Complete(std::unique_ptr<Operation> operation);
+
+        std::vector<std::string> m_Inputs;
+        size_t m_ReadAhead;
+        std::unique_ptr<Ring> m_Ring;
+
+        std::mutex m_Mutex;
+        std::condition_variable m_Changed;
+        size_t m_NextTake = 0;
+        size_t m_NextRead = 0;
+        // By input index, emptied when taken
+        std::vector<ReadSlot> m_Read;
+        // Writes handed to the I/O thread and not completed yet
+        std::vector<std::unique_ptr<Operation>> m_NewWrites;
+        size_t m_PendingWrites = 0;
+        std::vector<std::string> m_FailedWrites;
+        bool m_Stop = false;
+
+        std::thread m_Thread;
+    };
+}
\ No newline at end of file
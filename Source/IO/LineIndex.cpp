@@ -0,0 +1,29 @@
+#include "LineIndex.h"
+
+#include "Assembler/Scan.h"
+
+#include <algorithm>
+
+IO::LineIndex::LineIndex(std::string_view source) : m_Source(source) {
+    m_LineStarts.push_back(0);
+    for (size_t position = Scan::FindNewline(source, 0); position < source.size(); position = Scan::FindNewline(source, position + 1)) {
+        m_LineStarts.push_back(position + 1);
+    }
+}
+
+std::string_view IO::LineIndex::GetLine(size_t offset, size_t lineNumber) const {
+    offset = std::min(offset, m_Source.size());
+
+    size_t line = lineNumber - 1;
+    if (line >= m_LineStarts.size() || m_LineStarts[line] > offset || (line + 1 < m_LineStarts.size() && m_LineStarts[line + 1] <= offset)) {
+        line = std::upper_bound(m_LineStarts.begin(), m_LineStarts.end(), offset) - m_LineStarts.begin() - 1;
+    }
+
+    size_t end = line + 1 < m_LineStarts.size() ? m_LineStarts[line + 1] - 1 : m_Source.size();
+    std::string_view result = m_Source.substr(offset, end - offset);
+    if (result.ends_with('\r')) {
+        result.remove_suffix(1);
+    }
+
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+#include <string_view>
+
+namespace IO {
+    // Offsets of every line start in a source buffer, so that diagnostics can slice out
+    // their line without searching or seeking in the input.
+    class LineIndex {
+    public:
+        LineIndex(std::string_view source);
+
+        inline std::string_view Source() const { return m_Source; }
+        inline size_t LineCount() const { return m_LineStarts.size(); }
+
+        // Returns the text from offset to the end of its line, without the line terminator.
+        // lineNumber is the expected line of offset and only used as a hint.
+        std::string_view GetLine(size_t offset, size_t lineNumber) const;
+    private:
+        std::string_view m_Source;
+        std::vector<size_t> m_LineStarts;
+    };
+}
\ No newline at end of file
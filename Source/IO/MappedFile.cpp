@@ -0,0 +1,172 @@
+#include "MappedFile.h"
+
+#include "Assembler/Trace.h"
+
+#include <utility>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <cerrno>
+#endif
+
+IO::MappedFile::MappedFile(MappedFile&& other) noexcept 
+    : m_Data(std::exchange(other.m_Data, nullptr)), m_Size(std::exchange(other.m_Size, 0)), m_Mapped(std::exchange(other.m_Mapped, false)), m_Buffer(std::move(other.m_Buffer)) {}
+
+IO::MappedFile& IO::MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Unmap();
+        m_Data = std::exchange(other.m_Data, nullptr);
+        m_Size = std::exchange(other.m_Size, 0);
+        m_Mapped = std::exchange(other.m_Mapped, false);
+        m_Buffer = std::move(other.m_Buffer);
+    }
+
+    return *this;
+}
+
+IO::MappedFile::~MappedFile() {
+    Unmap();
+}
+
+#ifdef _WIN32
+
+std::optional<IO::MappedFile> IO::MappedFile::TryOpen(const std::string& fileName) {
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return std::nullopt;
+    }
+
+    auto result = Load(file);
+    CloseHandle(file);
+    return result;
+}
+
+std::optional<IO::MappedFile> IO::MappedFile::TryOpenStandardInput() {
+    HANDLE file = GetStdHandle(STD_INPUT_HANDLE);
+    if (file == INVALID_HANDLE_VALUE || file == nullptr) {
+        return std::nullopt;
+    }
+
+    return Load(file);
+}
+
+std::optional<IO::MappedFile> IO::MappedFile::Load(NativeHandle file) {
+    Trace::Zone zone("map input");
+    MappedFile result;
+    LARGE_INTEGER size{};
+    if (GetFileType(file) == FILE_TYPE_DISK && GetFileSizeEx(file, &size)) {
+        if (size.QuadPart == 0) {
+            return result;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+        if (mapping) { CloseHandle(mapping); }
+
+        if (!view) {
+            return std::nullopt;
+        }
+
+        result.m_Data = static_cast<const char*>(view);
+        result.m_Size = static_cast<size_t>(size.QuadPart);
+        result.m_Mapped = true;
+        return result;
+    }
+
+    char buffer[64 * 1024];
+    DWORD bytesRead = 0;
+    for (;;) {
+        if (!ReadFile(file, buffer, sizeof(buffer), &bytesRead, nullptr)) {
+            // Pipes end with an error once the writer closes them
+            return GetLastError() == ERROR_BROKEN_PIPE ? std::optional<MappedFile>(std::move(result)) : std::nullopt;
+        }
+
+        if (bytesRead == 0) {
+            return result;
+        }
+
+        result.m_Buffer.append(buffer, bytesRead);
+    }
+}
+
+void IO::MappedFile::Unmap() {
+    if (m_Mapped) {
+        UnmapViewOfFile(m_Data);
+        m_Mapped = false;
+    }
+}
+
+#else
+
+std::optional<IO::MappedFile> IO::MappedFile::TryOpen(const std::string& fileName) {
+    int file = open(fileName.c_str(), O_RDONLY);
+    if (file < 0) {
+        return std::nullopt;
+    }
+
+    auto result = Load(file);
+    close(file);
+    return result;
+}
+
+std::optional<IO::MappedFile> IO::MappedFile::TryOpenStandardInput() {
+    return Load(STDIN_FILENO);
+}
+
+std::optional<IO::MappedFile> IO::MappedFile::Load(NativeHandle file) {
+    Trace::Zone zone("map input");
+    MappedFile result;
+    struct stat info{};
+    if (fstat(file, &info) == 0 && S_ISREG(info.st_mode)) {
+        if (info.st_size == 0) {
+            return result;
+        }
+
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        if (view == MAP_FAILED) {
+            return std::nullopt;
+        }
+
+        madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+
+        result.m_Data = static_cast<const char*>(view);
+        result.m_Size = static_cast<size_t>(info.st_size);
+        result.m_Mapped = true;
+        return result;
+    }
+
+    char buffer[64 * 1024];
+    for (;;) {
+        const ssize_t bytesRead = read(file, buffer, sizeof(buffer));
+        if (bytesRead == 0) {
+            return result;
+        }
+
+        if (bytesRead < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return std::nullopt;
+        }
+
+        result.m_Buffer.append(buffer, static_cast<size_t>(bytesRead));
+    }
+}
+
+void IO::MappedFile::Unmap() {
+    if (m_Mapped) {
+        munmap(const_cast<char*>(m_Data), m_Size);
+        m_Mapped = false;
+    }
+}
+
+#endif
\ No newline at end of file
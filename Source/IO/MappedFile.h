@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <optional>
+
+namespace IO {
+    // Read-only view of a whole input file. Regular files are memory mapped,
+    // anything else (pipes, character devices) is read into an owned buffer.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        // Contents that were already read some other way, i.e. by a FileQueue
+        explicit MappedFile(std::string buffer) : m_Buffer(std::move(buffer)) {}
+        MappedFile(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        ~MappedFile();
+
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        [[nodiscard]] static std::optional<MappedFile> TryOpen(const std::string& fileName);
+        [[nodiscard]] static std::optional<MappedFile> TryOpenStandardInput();
+
+        inline std::string_view View() const { return m_Mapped ? std::string_view(m_Data, m_Size) : std::string_view(m_Buffer); }
+    private:
+#ifdef _WIN32
+        using NativeHandle = void*;
+#else
+        using NativeHandle = int;
+#endif
+        // Does not take ownership of the handle
+        static std::optional<MappedFile> Load(NativeHandle file);
+        void Unmap();
+
+        const char* m_Data = nullptr;
+        size_t m_Size = 0;
+        bool m_Mapped = false;
+        std::string m_Buffer;
+    };
+}
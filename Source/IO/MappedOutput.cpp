@@ -0,0 +1,184 @@
+#include "MappedOutput.h"
+
+#include <utility>
+#include <algorithm>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+
+    #include <cerrno>
+#endif
+
+IO::MappedOutput::MappedOutput(MappedOutput&& other) noexcept 
+    : m_File(std::exchange(other.m_File, InvalidHandle)), m_Data(std::exchange(other.m_Data, nullptr)), m_Size(std::exchange(other.m_Size, 0)) {}
+
+IO::MappedOutput& IO::MappedOutput::operator=(MappedOutput&& other) noexcept {
+    if (this != &other) {
+        Close();
+        m_File = std::exchange(other.m_File, InvalidHandle);
+        m_Data = std::exchange(other.m_Data, nullptr);
+        m_Size = std::exchange(other.m_Size, 0);
+    }
+
+    return *this;
+}
+
+IO::MappedOutput::~MappedOutput() {
+    Close();
+}
+
+#ifdef _WIN32
+
+std::optional<IO::MappedOutput> IO::MappedOutput::TryOpen(const std::string& fileName) {
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return std::nullopt;
+    }
+
+    return MappedOutput(file);
+}
+
+std::span<char> IO::MappedOutput::Map(size_t size) {
+    LARGE_INTEGER end{};
+    end.QuadPart = static_cast<LONGLONG>(size);
+    if (size == 0 || GetFileType(m_File) != FILE_TYPE_DISK) {
+        return {};
+    }
+
+    void* view = nullptr;
+    if (SetFilePointerEx(m_File, end, nullptr, FILE_BEGIN) && SetEndOfFile(m_File)) {
+        HANDLE mapping = CreateFileMappingA(m_File, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+        view = mapping ? MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size) : nullptr;
+
+        if (mapping) { CloseHandle(mapping); }
+    }
+
+    if (!view) {
+        // Write must start at the beginning of an empty file, not after the size set above
+        LARGE_INTEGER start{};
+        SetFilePointerEx(m_File, start, nullptr, FILE_BEGIN);
+        SetEndOfFile(m_File);
+        return {};
+    }
+
+    m_Data = static_cast<char*>(view);
+    m_Size = size;
+    return { m_Data, m_Size };
+}
+
+bool IO::MappedOutput::Write(std::string_view data) {
+    while (!data.empty()) {
+        DWORD written = 0;
+        if (!WriteFile(m_File, data.data(), static_cast<DWORD>(std::min<size_t>(data.size(), 1 << 30)), &written, nullptr)) {
+            return false;
+        }
+
+        data.remove_prefix(written);
+    }
+
+    return true;
+}
+
+bool IO::MappedOutput::Close() {
+    bool success = true;
+    if (m_Data) {
+        success = UnmapViewOfFile(m_Data) != 0;
+        m_Data = nullptr;
+        m_Size = 0;
+    }
+
+    if (m_File != InvalidHandle) {
+        success &= CloseHandle(m_File) != 0;
+        m_File = InvalidHandle;
+    }
+
+    return success;
+}
+
+#else
+
+std::optional<IO::MappedOutput> IO::MappedOutput::TryOpen(const std::string& fileName) {
+    int file = open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (file < 0) {
+        // Write-only outputs, i.e. some devices, can still be written without a mapping
+        file = open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    }
+
+    if (file < 0) {
+        return std::nullopt;
+    }
+
+    return MappedOutput(file);
+}
+
+// The blocks are reserved before mapping. Writing a hole of a sparse file through the mapping
+// raises SIGBUS when the disk is full, a failed reservation falls back to Write and reports the error
+std::span<char> IO::MappedOutput::Map(size_t size) {
+    struct stat info{};
+    if (size == 0 || fstat(m_File, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return {};
+    }
+
+#ifdef __APPLE__
+    // No posix_fallocate
+    return {};
+#else
+    if (posix_fallocate(m_File, 0, static_cast<off_t>(size)) != 0) {
+        // It may have extended the file part of the way
+        [[maybe_unused]] int truncated = ftruncate(m_File, 0);
+        return {};
+    }
+#endif
+
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_File, 0);
+    if (view == MAP_FAILED) {
+        return {};
+    }
+
+    m_Data = static_cast<char*>(view);
+    m_Size = size;
+    return { m_Data, m_Size };
+}
+
+bool IO::MappedOutput::Write(std::string_view data) {
+    while (!data.empty()) {
+        ssize_t written = write(m_File, data.data(), data.size());
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (written < 0) {
+            return false;
+        }
+
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+
+    return true;
+}
+
+bool IO::MappedOutput::Close() {
+    bool success = true;
+    // Written back by the page cache, the blocks were reserved by Map
+    if (m_Data) {
+        success = munmap(m_Data, m_Size) == 0;
+        m_Data = nullptr;
+        m_Size = 0;
+    }
+
+    if (m_File != InvalidHandle) {
+        success &= close(m_File) == 0;
+        m_File = InvalidHandle;
+    }
+
+    return success;
+}
+
+#endif
\ No newline at end of file
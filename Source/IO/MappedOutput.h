@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <span>
+
+namespace IO {
+    // Output file whose size is known before it is written. Regular files are sized once and written 
+    // through a shared memory mapping, anything else (pipes, character devices) with plain writes.
+    class MappedOutput {
+    public:
+        MappedOutput(const MappedOutput&) = delete;
+        MappedOutput(MappedOutput&& other) noexcept;
+        ~MappedOutput();
+
+        MappedOutput& operator=(const MappedOutput&) = delete;
+        MappedOutput& operator=(MappedOutput&& other) noexcept;
+
+        // Creates or truncates the file
+        [[nodiscard]] static std::optional<MappedOutput> TryOpen(const std::string& fileName);
+
+        // Sizes the file and maps it for writing. Empty if it can not be mapped, then use Write instead
+        std::span<char> Map(size_t size);
+        bool Write(std::string_view data);
+        // Unmaps the file, writing back the mapping, and closes it
+        bool Close();
+    private:
+#ifdef _WIN32
+        using NativeHandle = void*;
+        static inline const NativeHandle InvalidHandle = reinterpret_cast<NativeHandle>(-1);
+#else
+        using NativeHandle = int;
+        static constexpr NativeHandle InvalidHandle = -1;
+#endif
+        MappedOutput(NativeHandle file) : m_File(file) {}
+
+        NativeHandle m_File = InvalidHandle;
+        char* m_Data = nullptr;
+        size_t m_Size = 0;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "Memory.h"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
+    #include <Psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+#ifdef _WIN32
+
+std::optional<size_t> IO::GetPeakResidentSize() {
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return std::nullopt;
+    }
+
+    return counters.PeakWorkingSetSize;
+}
+
+#else
+
+std::optional<size_t> IO::GetPeakResidentSize() {
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return std::nullopt;
+    }
+
+    // Bytes on macOS, kilobytes everywhere else
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+#endif
\ No newline at end of file
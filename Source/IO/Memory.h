@@ -0,0 +1,9 @@
+#pragma once
+
+#include <optional>
+#include <cstddef>
+
+namespace IO {
+    // The largest the resident set of the process has been so far, in bytes. Empty where the platform does not report it
+    std::optional<size_t> GetPeakResidentSize();
+}
\ No newline at end of file